@@ -11,7 +11,6 @@
 #include "CriticalError.hpp"
 
 #include <string>
-#include <algorithm>  // find
 
 
 namespace own {
@@ -33,6 +32,13 @@ namespace own {
 	writeError( typeDesc.c_str(), totalSize );
 }
 
+[[noreturn]] void BinaryOutputStream::lengthPrefixError( size_t length, size_t prefixSize )
+{
+	CRITICAL_ERROR(
+		"Attempted to write length %zu into a length field of only %zu bytes", length, prefixSize
+	);
+}
+
 
 //======================================================================================================================
 // more complex writing operations
@@ -53,12 +59,28 @@ bool BinaryInputStream::readString( std::string & str, size_t size ) noexcept
 	return !_failed;
 }
 
+const uint8_t * BinaryInputStream::findString0End() noexcept
+{
+	const uint8_t * strEndPos = findByte( _curPos, _endPos, '\0' );
+	while (strEndPos == _endPos && _refillBuffer)
+	{
+		// the buffer may be moved by the refill, so remember only how much we have already searched
+		const size_t searchedSize = remaining();
+		_refillBuffer( *this, searchedSize + 1 );
+		if (remaining() == searchedSize)
+		{
+			break;  // there are no more data
+		}
+		strEndPos = findByte( _curPos + searchedSize, _endPos, '\0' );
+	}
+	return strEndPos != _endPos ? strEndPos : nullptr;
+}
+
 bool BinaryInputStream::readString0( std::string & str ) noexcept
 {
 	if (!_failed)
 	{
-		const uint8_t * strEndPos = std::find( _curPos, _endPos, '\0' );
-		if (strEndPos != _endPos)
+		if (const uint8_t * strEndPos = findString0End())
 		{
 			const size_t strSize = size_t( strEndPos - _curPos );
 			str.resize( strSize );
@@ -73,6 +95,43 @@ bool BinaryInputStream::readString0( std::string & str ) noexcept
 	return !_failed;
 }
 
+const_byte_span BinaryInputStream::readVarLengthPrefixedData() noexcept
+{
+	const_byte_span data;
+	if (!_failed)
+	{
+		refillForVarInt();
+		size_t length = 0;
+		const size_t prefixSize = decodeVarUInt( _curPos, _endPos, length );
+		// the prefix is consumed only together with the data, so that a refilling stream can simply retry the read
+		if (prefixSize != 0 && length <= std::numeric_limits< size_t >::max() - prefixSize && checkRead( prefixSize + length ))
+		{
+			data = make_span( _curPos + prefixSize, length );
+			_curPos += prefixSize + length;
+		}
+		_failed = data.data() == nullptr;
+	}
+	return data;
+}
+
+const_char_span BinaryInputStream::readString0View() noexcept
+{
+	const_char_span str;
+	if (!_failed)
+	{
+		if (const uint8_t * strEndPos = findString0End())
+		{
+			str = make_span( reinterpret_cast< const char * >( _curPos ), reinterpret_cast< const char * >( strEndPos ) );
+			_curPos = strEndPos + 1;
+		}
+		else
+		{
+			_failed = true;
+		}
+	}
+	return str;
+}
+
 
 //======================================================================================================================
 
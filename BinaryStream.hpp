@@ -11,15 +11,20 @@
 
 #include "Essential.hpp"
 
-#include "TypeTraits.hpp"  // is_int_or_enum
+#include "TypeTraits.hpp"  // is_endian_serializable
 #include "Span.hpp"
 #include "Endianity.hpp"
+#include "VarInt.hpp"
 #include "MemAccessUtils.hpp"
 #include "SafetyChecks.hpp"
 
 #include <string>
-#include <vector>  // toByteVector, fromByteVector
+#include <vector>  // toByteVector, fromByteVector, GrowingBinaryOutputStream
+#include <memory>  // allocator, allocator_traits
+#include <type_traits>
+#include <algorithm>  // max
 #include <typeinfo>
+#include <limits>  // length prefix range
 
 
 namespace own {
@@ -29,6 +34,185 @@ class BinaryOutputStreamLE;
 class BinaryOutputStreamBE;
 class BinaryInputStreamLE;
 class BinaryInputStreamBE;
+template< typename Int, Endianity endianity > class ReservedField;
+
+
+//======================================================================================================================
+/// Writer of a fixed-size record reserved in a BinaryOutputStream via reserveRecord().
+/** The bounds are checked only once for the whole record when it is reserved, the writes of the individual fields
+  * are not checked at all (except for builds with SAFETY_CHECKS). Use this for fixed-layout headers and messages.
+  * WARNING: The cursor points directly into the buffer of the stream, it must not be used after anything else
+  * is written into the stream, because the stream may re-allocate its buffer. */
+
+class OutputRecordCursor
+{
+
+	uint8_t * _curPos;  ///< current position in the record
+	uint8_t * _endPos;  ///< position of the end of the record
+
+ public:
+
+	OutputRecordCursor( byte_span record ) noexcept
+		: _curPos( record.data() ), _endPos( record.data() + record.size() ) {}
+
+	/// Writes a single byte into the record.
+	template< typename Byte, REQUIRES( is_byte_alike<Byte>::value ) >
+	void put( Byte b )
+	{
+		SAFETY_CHECK( _curPos < _endPos, "Attempted to write past the end of the reserved record" );
+		*_curPos = uint8_t( b );
+		_curPos++;
+	}
+
+	/// Converts an arbitrary number from native format to little endian and writes it into the record.
+	template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+	void writeLittleEndian( Type native )
+	{
+		SAFETY_CHECK( sizeof( Type ) <= remaining(), "Attempted to write past the end of the reserved record" );
+		own::writeLittleEndian( _curPos, native );
+		_curPos += sizeof( Type );
+	}
+
+	/// Converts an arbitrary number from native format to big endian and writes it into the record.
+	template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+	void writeBigEndian( Type native )
+	{
+		SAFETY_CHECK( sizeof( Type ) <= remaining(), "Attempted to write past the end of the reserved record" );
+		own::writeBigEndian( _curPos, native );
+		_curPos += sizeof( Type );
+	}
+
+	/// Writes specified number of bytes from a continuous memory storage into the record.
+	template< typename Range, REQUIRES( is_range_of_byte_alikes<Range>::value && has_contiguous_data<Range>::value ) >
+	void writeBytes( const Range & bytes )
+	{
+		const size_t writeSize = fut::size( bytes );
+		SAFETY_CHECK( writeSize <= remaining(), "Attempted to write past the end of the reserved record" );
+		copyBytes( reinterpret_cast< const uint8_t * >( fut::data( bytes ) ), _curPos, writeSize );
+		_curPos += writeSize;
+	}
+
+	/// Writes specified number of zero bytes into the record.
+	void writeZeroBytes( size_t numZeroBytes )
+	{
+		SAFETY_CHECK( numZeroBytes <= remaining(), "Attempted to write past the end of the reserved record" );
+		zeroBytes( _curPos, numZeroBytes );
+		_curPos += numZeroBytes;
+	}
+
+	/// Moves over specified number of bytes and leaves them unchanged.
+	void skip( size_t numBytes )
+	{
+		SAFETY_CHECK( numBytes <= remaining(), "Attempted to skip past the end of the reserved record" );
+		_curPos += numBytes;
+	}
+
+	/// Returns how many bytes of the record remain to be written.
+	size_t remaining() const noexcept
+	{
+		return size_t( _endPos - _curPos );
+	}
+
+	/// Returns the part of the record that remains to be written, for encoding it by other means.
+	byte_span remainingBytes() const noexcept
+	{
+		return { _curPos, _endPos };
+	}
+
+};
+
+
+//======================================================================================================================
+/// Reader of a fixed-size record reserved in a BinaryInputStream via reserveRecord().
+/** The bounds are checked only once for the whole record when it is reserved, the reads of the individual fields
+  * are not checked at all (except for builds with SAFETY_CHECKS). Use this for fixed-layout headers and messages.
+  * If the stream didn't have enough data for the record, the cursor is invalid and must not be read from,
+  * always check isValid() first.
+  * WARNING: The cursor points directly into the buffer of the stream, it is valid only until the next read
+  * from the stream, because some streams may replace the content of their buffer. */
+
+class InputRecordCursor
+{
+
+	const uint8_t * _curPos;  ///< current position in the record
+	const uint8_t * _endPos;  ///< position of the end of the record
+	bool _isValid;  ///< the record was successfully reserved
+
+ public:
+
+	/// Constructs an invalid cursor.
+	InputRecordCursor() noexcept
+		: _curPos( nullptr ), _endPos( nullptr ), _isValid( false ) {}
+
+	InputRecordCursor( const_byte_span record ) noexcept
+		: _curPos( record.data() ), _endPos( record.data() + record.size() ), _isValid( true ) {}
+
+	/// Returns false if the stream didn't have enough data for the record.
+	bool isValid() const noexcept  { return _isValid; }
+	explicit operator bool() const noexcept  { return _isValid; }
+
+	/// Reads a single byte from the record.
+	template< typename Byte, REQUIRES( is_byte_alike<Byte>::value ) >
+	Byte get()
+	{
+		SAFETY_CHECK( _curPos < _endPos, "Attempted to read past the end of the reserved record" );
+		return Byte( *(_curPos++) );
+	}
+
+	uint8_t getByte()
+	{
+		return get< uint8_t >();
+	}
+
+	/// Reads an arbitrary number from the record and converts it from little endian to native format.
+	template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+	Type readLittleEndian()
+	{
+		SAFETY_CHECK( sizeof( Type ) <= remaining(), "Attempted to read past the end of the reserved record" );
+		const Type native = own::readLittleEndian< Type >( _curPos );
+		_curPos += sizeof( Type );
+		return native;
+	}
+
+	/// Reads an arbitrary number from the record and converts it from big endian to native format.
+	template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+	Type readBigEndian()
+	{
+		SAFETY_CHECK( sizeof( Type ) <= remaining(), "Attempted to read past the end of the reserved record" );
+		const Type native = own::readBigEndian< Type >( _curPos );
+		_curPos += sizeof( Type );
+		return native;
+	}
+
+	/// Reads a range of bytes from the record into a given pre-allocated container.
+	template< typename Byte, REQUIRES( is_byte_alike<Byte>::value ) >
+	void readBytes( span< Byte > bytes )
+	{
+		SAFETY_CHECK( bytes.size() <= remaining(), "Attempted to read past the end of the reserved record" );
+		copyBytes( _curPos, reinterpret_cast< uint8_t * >( bytes.data() ), bytes.size() );
+		_curPos += bytes.size();
+	}
+
+	/// Moves over specified number of bytes without returning them to the user.
+	void skip( size_t numBytes )
+	{
+		SAFETY_CHECK( numBytes <= remaining(), "Attempted to skip past the end of the reserved record" );
+		_curPos += numBytes;
+	}
+
+	/// Returns how many bytes of the record remain to be read.
+	size_t remaining() const noexcept
+	{
+		return size_t( _endPos - _curPos );
+	}
+
+	/// Returns the part of the record that remains to be read, for decoding it by other means.
+	const_byte_span remainingBytes() const noexcept
+	{
+		return { _curPos, _endPos };
+	}
+
+};
 
 
 //======================================================================================================================
@@ -41,21 +225,24 @@ class BinaryOutputStream
 
  protected:
 
+	/// Function that makes room for at least \p requiredSize more bytes after the current position of the \p stream.
+	using GrowFunc = void (*)( BinaryOutputStream & stream, size_t requiredSize );
+
 	uint8_t * _begPos;  ///< position of the beginning of the buffer
 	uint8_t * _curPos;  ///< current position in the buffer
 	uint8_t * _endPos;  ///< position of the end of the buffer
+	GrowFunc _growBuffer;  ///< called when a write doesn't fit into the buffer, nullptr if the buffer can't grow
 
  public:
 
 	BinaryOutputStream( const BinaryOutputStream & ) = delete;
-	BinaryOutputStream( BinaryOutputStream && ) = default;
 	BinaryOutputStream & operator=( const BinaryOutputStream & other ) = delete;
-	BinaryOutputStream & operator=( BinaryOutputStream && other ) = default;
 
 	/// Initializes a binary output stream operating over any byte container with continuous memory.
 	/** WARNING: The class takes non-owning reference to a buffer. You are responsible for making sure the buffer exists
 	  * at least as long as this object and for allocating the storage big enough for all write operations to fit in. */
 	BinaryOutputStream( byte_span buffer ) noexcept
+		: _growBuffer( nullptr )
 	{
 		reset( buffer );
 	}
@@ -89,8 +276,8 @@ class BinaryOutputStream
 
 	//-- integers ------------------------------------------------------------------------------------------------------
 
-	/// Converts an arbitrary integral number from native format to little endian and writes it into the buffer.
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	/// Converts an arbitrary number from native format to little endian and writes it into the buffer.
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	void writeLittleEndian( Int native )
 	{
 		const size_t writeSize = checkWrite< Int >();
@@ -98,8 +285,8 @@ class BinaryOutputStream
 		_curPos += writeSize;
 	}
 
-	/// Converts an arbitrary integral number from native format to big endian and writes it into the buffer.
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	/// Converts an arbitrary number from native format to big endian and writes it into the buffer.
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	void writeBigEndian( Int native )
 	{
 		const size_t writeSize = checkWrite< Int >();
@@ -107,9 +294,117 @@ class BinaryOutputStream
 		_curPos += writeSize;
 	}
 
+	/// Converts an array of numbers from native format to little endian and writes it into the buffer.
+	/** This is much faster than writing the numbers one by one, the whole array is converted at once. */
+	template< typename Range, REQUIRES( is_endian_serializable_range<Range>::value && has_contiguous_data<Range>::value ) >
+	void writeLittleEndianArray( const Range & array )
+	{
+		using Element = typename range_value< Range >::type;
+		const size_t writeSize = checkWrite< Element >( fut::size( array ) );
+		own::writeLittleEndianArray( _curPos, fut::data( array ), fut::size( array ) );
+		_curPos += writeSize;
+	}
+
+	/// Converts an array of numbers from native format to big endian and writes it into the buffer.
+	/** This is much faster than writing the numbers one by one, the whole array is converted at once. */
+	template< typename Range, REQUIRES( is_endian_serializable_range<Range>::value && has_contiguous_data<Range>::value ) >
+	void writeBigEndianArray( const Range & array )
+	{
+		using Element = typename range_value< Range >::type;
+		const size_t writeSize = checkWrite< Element >( fut::size( array ) );
+		own::writeBigEndianArray( _curPos, fut::data( array ), fut::size( array ) );
+		_curPos += writeSize;
+	}
+
 	inline BinaryOutputStreamLE & getLittleEndianStream();
 	inline BinaryOutputStreamBE & getBigEndianStream();
 
+	//-- variable-length integers --------------------------------------------------------------------------------------
+
+	/// Writes an unsigned integer in the variable-length format (LEB128), smaller numbers take less bytes.
+	template< typename UInt, REQUIRES( std::is_integral<UInt>::value && std::is_unsigned<UInt>::value ) >
+	void writeVarUInt( UInt value )
+	{
+		const size_t writeSize = checkWrite( "varint", varUIntSize( value ) );
+		encodeVarUInt( _curPos, value );
+		_curPos += writeSize;
+	}
+
+	/// Writes a signed integer in the variable-length format (ZigZag + LEB128), numbers closer to 0 take less bytes.
+	template< typename Int, REQUIRES( std::is_integral<Int>::value && std::is_signed<Int>::value ) >
+	void writeVarInt( Int value )
+	{
+		writeVarUInt( zigZagEncode( value ) );
+	}
+
+	//-- fixed-size records and structs ---------------------------------------------------------------------------------
+
+	/// Reserves space for a record of fixed size and returns a cursor for writing its fields without further checks.
+	/** The position of the stream moves right behind the record. See OutputRecordCursor for details. */
+	OutputRecordCursor reserveRecord( size_t recordSize )
+	{
+		const size_t writeSize = checkWrite( "record", recordSize );
+		OutputRecordCursor cursor( make_span( _curPos, writeSize ) );
+		_curPos += writeSize;
+		return cursor;
+	}
+
+	/// Encodes a struct according to its StructLayout, with a single bounds check for the whole struct.
+	template< typename Layout >
+	void writeStruct( const typename Layout::struct_type & obj )
+	{
+		const size_t writeSize = checkWrite( "struct", Layout::c_size );
+		Layout::encode( obj, _curPos );
+		_curPos += writeSize;
+	}
+
+	//-- placeholders --------------------------------------------------------------------------------------------------
+
+	/// Reserves space for a number whose value is not known yet and returns a placeholder for filling it in later.
+	/** Typical use is a length of a message that precedes its body, see ReservedField for details.
+	  * The field is initialized to 0 until it's filled in. */
+	template< typename Int, Endianity endianity, REQUIRES( std::is_integral<Int>::value ) >
+	ReservedField< Int, endianity > reserveField()
+	{
+		const size_t writeSize = checkWrite< Int >();
+		ReservedField< Int, endianity > field( *this, offset() );
+		writeWithEndianity< endianity >( _curPos, Int(0) );
+		_curPos += writeSize;
+		return field;
+	}
+
+	//-- alignment -----------------------------------------------------------------------------------------------------
+
+	/// Writes zero bytes until the offset of the stream is a multiple of \p alignment.
+	void alignTo( size_t alignment )
+	{
+		writeZeroBytes( paddingTo( offset(), alignment ) );
+	}
+
+	/// Converts a number from native format to little endian and writes it to a position aligned to the number's size.
+	/** This uses faster instructions on CPUs that penalize unaligned access.
+	  * If the buffer itself is aligned, the aligned position can be reached using alignTo( sizeof( Int ) ). */
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
+	void writeLittleEndian_aligned( Int native )
+	{
+		const size_t writeSize = checkWrite< Int >();  // growing the buffer may change the position
+		SAFETY_CHECK( isAligned( _curPos, sizeof( Int ) ), "Attempted an aligned write to an unaligned position" );
+		own::writeLittleEndian_aligned( _curPos, native );
+		_curPos += writeSize;
+	}
+
+	/// Converts a number from native format to big endian and writes it to a position aligned to the number's size.
+	/** This uses faster instructions on CPUs that penalize unaligned access.
+	  * If the buffer itself is aligned, the aligned position can be reached using alignTo( sizeof( Int ) ). */
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
+	void writeBigEndian_aligned( Int native )
+	{
+		const size_t writeSize = checkWrite< Int >();  // growing the buffer may change the position
+		SAFETY_CHECK( isAligned( _curPos, sizeof( Int ) ), "Attempted an aligned write to an unaligned position" );
+		own::writeBigEndian_aligned( _curPos, native );
+		_curPos += writeSize;
+	}
+
 	//-- arrays and strings --------------------------------------------------------------------------------------------
 
 	/// Writes specified number of bytes from a continuous memory storage to the buffer.
@@ -155,6 +450,41 @@ class BinaryOutputStream
 		_curPos += writeSize;
 	}
 
+	//-- length-prefixed data ------------------------------------------------------------------------------------------
+
+	/// Writes a range of bytes (string, blob, ...) preceded by its length stored as PrefixInt in the selected endianity.
+	/** The prefix and the data are written with a single bounds check.
+	  * If the length doesn't fit into PrefixInt, a critical error is raised instead of writing a truncated length. */
+	template< typename PrefixInt, Endianity endianity, typename Range, REQUIRES(
+		std::is_integral<PrefixInt>::value && std::is_unsigned<PrefixInt>::value
+		&& is_range_of_byte_alikes<Range>::value && has_contiguous_data<Range>::value
+	)>
+	void writeLengthPrefixed( const Range & bytes )
+	{
+		const size_t length = fut::size( bytes );
+		if (uint64_t( length ) > uint64_t( std::numeric_limits< PrefixInt >::max() ))
+		{
+			lengthPrefixError( length, sizeof( PrefixInt ) );
+		}
+		const size_t writeSize = checkWrite( "length-prefixed data", sizeof( PrefixInt ) + length );
+		writeWithEndianity< endianity >( _curPos, PrefixInt( length ) );
+		copyBytes( reinterpret_cast< const uint8_t * >( fut::data( bytes ) ), _curPos + sizeof( PrefixInt ), length );
+		_curPos += writeSize;
+	}
+
+	/// Writes a range of bytes (string, blob, ...) preceded by its length in the variable-length format (LEB128).
+	/** The prefix and the data are written with a single bounds check. */
+	template< typename Range, REQUIRES( is_range_of_byte_alikes<Range>::value && has_contiguous_data<Range>::value ) >
+	void writeVarLengthPrefixed( const Range & bytes )
+	{
+		const size_t length = fut::size( bytes );
+		const size_t prefixSize = varUIntSize( length );
+		const size_t writeSize = checkWrite( "length-prefixed data", prefixSize + length );
+		encodeVarUInt( _curPos, length );
+		copyBytes( reinterpret_cast< const uint8_t * >( fut::data( bytes ) ), _curPos + prefixSize, length );
+		_curPos += writeSize;
+	}
+
 	//-- convenience operators -----------------------------------------------------------------------------------------
 
 	template< typename Byte, REQUIRES( is_byte_alike<Byte>::value ) >  // same code for char, uint8_t, std::byte, ...
@@ -193,18 +523,54 @@ class BinaryOutputStream
 		return _curPos >= _endPos;
 	}
 
+	/// Returns the part of the buffer that has been written so far.
+	const_byte_span writtenBytes() const noexcept
+	{
+		return { _begPos, _curPos };
+	}
+
+ protected:
+
+	/// Constructor for subclasses that manage their own buffer and are able to enlarge it.
+	BinaryOutputStream( byte_span buffer, GrowFunc growBuffer ) noexcept
+		: _growBuffer( growBuffer )
+	{
+		reset( buffer );
+	}
+
+	// Moving is allowed only to subclasses, which move their buffer along. Moving a growing stream into a plain
+	// BinaryOutputStream would slice it, and the grow function would then be called with an object of a wrong type.
+	BinaryOutputStream( BinaryOutputStream && ) = default;
+	BinaryOutputStream & operator=( BinaryOutputStream && other ) = default;
+
  private:
 
+	// Returns false if numBytes can't be written at the current position.
+	// In builds without safety checks, the buffer size is verified only if the buffer can grow.
+	inline bool ensureSpace( size_t numBytes )
+	{
+	 #ifndef SAFETY_CHECKS
+		if (!_growBuffer)
+			return true;
+	 #endif
+		if (numBytes > remaining())  // not _curPos + numBytes, that could overflow with a corrupted size
+		{
+			if (!_growBuffer)
+				return false;
+			_growBuffer( *this, numBytes );
+			return numBytes <= remaining();  // growing the buffer may fail
+		}
+		return true;
+	}
+
 	template< typename Type >
 	inline size_t checkWrite()
 	{
 		constexpr size_t numBytes = sizeof( Type );
-	 #ifdef SAFETY_CHECKS
-		if (_curPos + numBytes > _endPos)
+		if (!ensureSpace( numBytes ))
 		{
 			writeError( typeid( Type ).name(), numBytes );
 		}
-	 #endif
 		return numBytes;
 	}
 
@@ -212,23 +578,19 @@ class BinaryOutputStream
 	inline size_t checkWrite( size_t elemCount )
 	{
 		const size_t numBytes = elemCount * sizeof( Element );
-	 #ifdef SAFETY_CHECKS
-		if (_curPos + numBytes > _endPos)
+		if (!ensureSpace( numBytes ))
 		{
 			writeArrayError( typeid( Element ).name(), numBytes );
 		}
-	 #endif
 		return numBytes;
 	}
 
-	inline size_t checkWrite( MAYBE_UNUSED const char * typeDesc, size_t numBytes )
+	inline size_t checkWrite( const char * typeDesc, size_t numBytes )
 	{
-	 #ifdef SAFETY_CHECKS
-		if (_curPos + numBytes > _endPos)
+		if (!ensureSpace( numBytes ))
 		{
 			writeError( typeDesc, numBytes );
 		}
-	 #endif
 		return numBytes;
 	}
 
@@ -236,6 +598,68 @@ class BinaryOutputStream
 
 	[[noreturn]] void writeArrayError( const char * elemDesc, size_t totalSize );
 
+	[[noreturn]] void lengthPrefixError( size_t length, size_t prefixSize );
+
+	template< typename Int, Endianity endianity > friend class ReservedField;
+
+};
+
+
+//======================================================================================================================
+/// Placeholder for a number in BinaryOutputStream whose value is filled in after more data have been written.
+/** It refers to the field by its offset from the beginning of the stream, so it stays valid even when a growing stream
+  * re-allocates its buffer. It becomes invalid when the stream is moved, reset or cleared.
+  * The streams that don't write into a single continuous buffer (SegmentedBinaryOutputStream) don't support it.
+  *
+  * Usage:
+  *
+  *   auto length = stream.reserveField< uint32_t, Endianity::Big >();
+  *   ... write the message body ...
+  *   length.setBytesSince(); */
+
+template< typename Int, Endianity endianity >
+class ReservedField
+{
+
+	BinaryOutputStream * _stream;
+	size_t _offset;  ///< offset of the field from the beginning of the stream
+
+ public:
+
+	ReservedField( BinaryOutputStream & stream, size_t offset ) noexcept
+		: _stream( &stream ), _offset( offset ) {}
+
+	/// Returns the offset of the field from the beginning of the stream.
+	size_t offset() const noexcept
+	{
+		return _offset;
+	}
+
+	/// Returns how many bytes have been written to the stream after this field.
+	size_t bytesSince() const noexcept
+	{
+		return _stream->offset() - (_offset + sizeof( Int ));
+	}
+
+	/// Fills in the value of the field.
+	void set( Int value )
+	{
+		SAFETY_CHECK( _offset + sizeof( Int ) <= _stream->offset(), "The reserved field is no longer part of the stream" );
+		writeWithEndianity< endianity >( _stream->_begPos + _offset, value );
+	}
+
+	/// Fills in the field with the number of bytes written to the stream after it.
+	/** If the number doesn't fit into Int, a critical error is raised instead of writing a truncated value. */
+	void setBytesSince()
+	{
+		const size_t length = bytesSince();
+		if (uint64_t( length ) > uint64_t( std::numeric_limits< Int >::max() ))
+		{
+			_stream->lengthPrefixError( length, sizeof( Int ) );
+		}
+		set( Int( length ) );
+	}
+
 };
 
 
@@ -251,22 +675,26 @@ class BinaryInputStream
 
  protected:
 
+	/// Function that tries to make at least \p requiredSize bytes available after the current position of the \p stream.
+	/** It may move the buffer, but it must not throw. If it doesn't succeed, the read fails as usual. */
+	using RefillFunc = void (*)( BinaryInputStream & stream, size_t requiredSize ) /*noexcept*/;
+
 	const uint8_t * _begPos;  ///< position of the beginning of the buffer
 	const uint8_t * _curPos;  ///< current position in the buffer
 	const uint8_t * _endPos;  ///< position of the end of the buffer
 	bool _failed;  ///< the end was reached while attemting to read from the buffer
+	RefillFunc _refillBuffer;  ///< called when a read reaches past the buffer end, nullptr if the buffer can't be refilled
 
  public:
 
 	BinaryInputStream( const BinaryInputStream & ) = delete;
-	BinaryInputStream( BinaryInputStream && ) = default;
 	BinaryInputStream & operator=( const BinaryInputStream & other ) = delete;
-	BinaryInputStream & operator=( BinaryInputStream && other ) = default;
 
 	/// Initializes a binary input stream operating over any byte container with continuous memory.
 	/** WARNING: The class takes non-owning reference to a buffer.
 	  * You are responsible for making sure the buffer exists at least as long as this object. */
 	BinaryInputStream( const_byte_span buffer ) noexcept
+		: _refillBuffer( nullptr )
 	{
 		reset( buffer );
 	}
@@ -325,9 +753,9 @@ class BinaryInputStream
 
 	//-- integers ------------------------------------------------------------------------------------------------------
 
-	/// Reads an arbitrary integral number from the buffer and converts it from big endian to native format.
+	/// Reads an arbitrary number from the buffer and converts it from big endian to native format.
 	/** (output parameter variant) */
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	bool readLittleEndian( Int & native ) noexcept
 	{
 		if (const size_t readSize = checkRead< Int >())
@@ -338,9 +766,9 @@ class BinaryInputStream
 		return !_failed;
 	}
 
-	/// Reads an arbitrary integral number from the buffer and converts it from little endian to native format.
+	/// Reads an arbitrary number from the buffer and converts it from little endian to native format.
 	/** (return value variant) */
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	Int readLittleEndian() noexcept
 	{
 		auto native = Int(0);
@@ -352,9 +780,9 @@ class BinaryInputStream
 		return native;
 	}
 
-	/// Reads an arbitrary integral number from the buffer and converts it from big endian to native format.
+	/// Reads an arbitrary number from the buffer and converts it from big endian to native format.
 	/** (output parameter variant) */
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	bool readBigEndian( Int & native ) noexcept
 	{
 		if (const size_t readSize = checkRead< Int >())
@@ -365,9 +793,9 @@ class BinaryInputStream
 		return !_failed;
 	}
 
-	/// Reads an arbitrary integral number from the buffer and converts it from big endian to native format.
+	/// Reads an arbitrary number from the buffer and converts it from big endian to native format.
 	/** (return value variant) */
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	Int readBigEndian() noexcept
 	{
 		auto native = Int(0);
@@ -379,9 +807,228 @@ class BinaryInputStream
 		return native;
 	}
 
+	/// Reads an array of numbers from the buffer and converts them from little endian to native format.
+	/** This is much faster than reading the numbers one by one, the whole array is converted at once. */
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
+	bool readLittleEndianArray( span< Int > array ) noexcept
+	{
+		if (const size_t readSize = checkRead< Int >( array.size() ))
+		{
+			own::readLittleEndianArray( _curPos, array.data(), array.size() );
+			_curPos += readSize;
+		}
+		return !_failed;
+	}
+
+	/// Reads an array of numbers from the buffer and converts them from little endian to native format.
+	/** This is much faster than reading the numbers one by one, the whole array is converted at once. */
+	template< typename Cont, REQUIRES( is_endian_serializable_range<Cont>::value && has_contiguous_data<Cont>::value ) >
+	bool readLittleEndianArray( Cont & cont ) noexcept
+	{
+		return readLittleEndianArray( make_span( cont ) );
+	}
+
+	/// Reads an array of numbers from the buffer and converts them from big endian to native format.
+	/** This is much faster than reading the numbers one by one, the whole array is converted at once. */
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
+	bool readBigEndianArray( span< Int > array ) noexcept
+	{
+		if (const size_t readSize = checkRead< Int >( array.size() ))
+		{
+			own::readBigEndianArray( _curPos, array.data(), array.size() );
+			_curPos += readSize;
+		}
+		return !_failed;
+	}
+
+	/// Reads an array of numbers from the buffer and converts them from big endian to native format.
+	/** This is much faster than reading the numbers one by one, the whole array is converted at once. */
+	template< typename Cont, REQUIRES( is_endian_serializable_range<Cont>::value && has_contiguous_data<Cont>::value ) >
+	bool readBigEndianArray( Cont & cont ) noexcept
+	{
+		return readBigEndianArray( make_span( cont ) );
+	}
+
 	inline BinaryInputStreamLE & getLittleEndianStream();
 	inline BinaryInputStreamBE & getBigEndianStream();
 
+	//-- variable-length integers --------------------------------------------------------------------------------------
+
+	/// Reads an unsigned integer in the variable-length format (LEB128).
+	/** (output parameter variant)
+	  * If the encoding is invalid or the number doesn't fit into UInt, the stream fails. */
+	template< typename UInt, REQUIRES( std::is_integral<UInt>::value && std::is_unsigned<UInt>::value ) >
+	bool readVarUInt( UInt & value ) noexcept
+	{
+		if (!_failed)
+		{
+			refillForVarInt();
+			const size_t readSize = decodeVarUInt( _curPos, _endPos, value );
+			_failed = readSize == 0;
+			_curPos += readSize;
+		}
+		return !_failed;
+	}
+
+	/// Reads an unsigned integer in the variable-length format (LEB128).
+	/** (return value variant)
+	  * If the encoding is invalid or the number doesn't fit into UInt, the stream fails. */
+	template< typename UInt, REQUIRES( std::is_integral<UInt>::value && std::is_unsigned<UInt>::value ) >
+	UInt readVarUInt() noexcept
+	{
+		auto value = UInt(0);
+		readVarUInt( value );
+		return value;
+	}
+
+	/// Reads a signed integer in the variable-length format (ZigZag + LEB128).
+	/** (output parameter variant)
+	  * If the encoding is invalid or the number doesn't fit into Int, the stream fails. */
+	template< typename Int, REQUIRES( std::is_integral<Int>::value && std::is_signed<Int>::value ) >
+	bool readVarInt( Int & value ) noexcept
+	{
+		typename std::make_unsigned< Int >::type encoded;
+		if (readVarUInt( encoded ))
+		{
+			value = zigZagDecode( encoded );
+		}
+		return !_failed;
+	}
+
+	/// Reads a signed integer in the variable-length format (ZigZag + LEB128).
+	/** (return value variant)
+	  * If the encoding is invalid or the number doesn't fit into Int, the stream fails. */
+	template< typename Int, REQUIRES( std::is_integral<Int>::value && std::is_signed<Int>::value ) >
+	Int readVarInt() noexcept
+	{
+		auto value = Int(0);
+		readVarInt( value );
+		return value;
+	}
+
+	/// Reads a sequence of unsigned integers in the variable-length format (LEB128) into a pre-allocated array.
+	/** This is considerably faster than reading the numbers one by one. */
+	template< typename UInt, REQUIRES( std::is_integral<UInt>::value && std::is_unsigned<UInt>::value ) >
+	bool readVarUIntArray( span< UInt > values ) noexcept
+	{
+		if (_refillBuffer)  // the numbers may not all be in the buffer at once
+		{
+			for (UInt & value : values)
+				readVarUInt( value );
+		}
+		else if (!_failed)
+		{
+			const uint8_t * newPos = decodeVarUIntArray( _curPos, _endPos, values.data(), values.size() );
+			_failed = newPos == nullptr;
+			_curPos = newPos ? newPos : _curPos;
+		}
+		return !_failed;
+	}
+
+	/// Reads a sequence of signed integers in the variable-length format (ZigZag + LEB128) into a pre-allocated array.
+	/** This is considerably faster than reading the numbers one by one. */
+	template< typename Int, REQUIRES( std::is_integral<Int>::value && std::is_signed<Int>::value ) >
+	bool readVarIntArray( span< Int > values ) noexcept
+	{
+		using UInt = typename std::make_unsigned< Int >::type;
+		// signed and unsigned variants of the same type are allowed to alias
+		if (readVarUIntArray( make_span( reinterpret_cast< UInt * >( values.data() ), values.size() ) ))
+		{
+			for (Int & value : values)
+				value = zigZagDecode( UInt( value ) );
+		}
+		return !_failed;
+	}
+
+	//-- fixed-size records and structs ---------------------------------------------------------------------------------
+
+	/// Reserves a record of fixed size and returns a cursor for reading its fields without further checks.
+	/** The position of the stream moves right behind the record. See InputRecordCursor for details.
+	  * If there is not enough data for the whole record, the stream fails and the returned cursor is invalid. */
+	InputRecordCursor reserveRecord( size_t recordSize ) noexcept
+	{
+		checkRead( recordSize );
+		if (_failed)
+		{
+			return InputRecordCursor();
+		}
+		InputRecordCursor cursor( make_span( _curPos, recordSize ) );
+		_curPos += recordSize;
+		return cursor;
+	}
+
+	/// Decodes a struct according to its StructLayout, with a single bounds check for the whole struct.
+	template< typename Layout >
+	bool readStruct( typename Layout::struct_type & obj ) noexcept
+	{
+		if (const size_t readSize = checkRead( Layout::c_size ))
+		{
+			Layout::decode( _curPos, obj );
+			_curPos += readSize;
+		}
+		return !_failed;
+	}
+
+	//-- alignment -----------------------------------------------------------------------------------------------------
+
+	/// Skips bytes until the offset of the stream is a multiple of \p alignment.
+	bool alignTo( size_t alignment ) noexcept
+	{
+		return skip( paddingTo( offset(), alignment ) );
+	}
+
+	/// Reads a number from a position aligned to the number's size and converts it from little endian to native format.
+	/** (output parameter variant)
+	  * This uses faster instructions on CPUs that penalize unaligned access.
+	  * If the buffer itself is aligned, the aligned position can be reached using alignTo( sizeof( Int ) ). */
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
+	bool readLittleEndian_aligned( Int & native )
+	{
+		if (const size_t readSize = checkRead< Int >())
+		{
+			SAFETY_CHECK( isAligned( _curPos, sizeof( Int ) ), "Attempted an aligned read from an unaligned position" );
+			native = own::readLittleEndian_aligned< Int >( _curPos );
+			_curPos += readSize;
+		}
+		return !_failed;
+	}
+
+	/// Reads a number from a position aligned to the number's size and converts it from little endian to native format.
+	/** (return value variant) */
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
+	Int readLittleEndian_aligned()
+	{
+		auto native = Int(0);
+		readLittleEndian_aligned( native );
+		return native;
+	}
+
+	/// Reads a number from a position aligned to the number's size and converts it from big endian to native format.
+	/** (output parameter variant)
+	  * This uses faster instructions on CPUs that penalize unaligned access.
+	  * If the buffer itself is aligned, the aligned position can be reached using alignTo( sizeof( Int ) ). */
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
+	bool readBigEndian_aligned( Int & native )
+	{
+		if (const size_t readSize = checkRead< Int >())
+		{
+			SAFETY_CHECK( isAligned( _curPos, sizeof( Int ) ), "Attempted an aligned read from an unaligned position" );
+			native = own::readBigEndian_aligned< Int >( _curPos );
+			_curPos += readSize;
+		}
+		return !_failed;
+	}
+
+	/// Reads a number from a position aligned to the number's size and converts it from big endian to native format.
+	/** (return value variant) */
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
+	Int readBigEndian_aligned()
+	{
+		auto native = Int(0);
+		readBigEndian_aligned( native );
+		return native;
+	}
+
 	//-- arrays and strings --------------------------------------------------------------------------------------------
 
 	// We must have overload for both generic container and span,
@@ -493,6 +1140,84 @@ class BinaryInputStream
 		return str;
 	}
 
+	//-- zero-copy views -----------------------------------------------------------------------------------------------
+
+	// The following methods return spans pointing directly into the buffer of the stream instead of copying the data.
+	// They are valid only as long as the buffer exists and for refilling streams only until the next read.
+	// If the read fails, an empty span is returned.
+
+	/// Reads a range of bytes of specified size from the buffer without copying it.
+	const_byte_span readByteSpan( size_t size ) noexcept
+	{
+		const_byte_span bytes;
+		if (const size_t readSize = checkRead( size ))
+		{
+			bytes = make_span( _curPos, readSize );
+			_curPos += readSize;
+		}
+		return bytes;
+	}
+
+	/// Reads a string of specified size from the buffer without copying it.
+	const_char_span readStringView( size_t size ) noexcept
+	{
+		const_char_span str;
+		if (const size_t readSize = checkRead( size ))
+		{
+			str = make_span( reinterpret_cast< const char * >( _curPos ), readSize );
+			_curPos += readSize;
+		}
+		return str;
+	}
+
+	/// Reads a string from the buffer until a null terminator is found, without copying it.
+	/** The null terminator is consumed, but it is not part of the returned span. */
+	const_char_span readString0View() noexcept;
+
+	//-- length-prefixed data ------------------------------------------------------------------------------------------
+
+	// Counterparts of BinaryOutputStream::writeLengthPrefixed() and writeVarLengthPrefixed().
+	// The View variants return a span pointing directly into the buffer, with the same validity as the zero-copy views.
+	// If the data are incomplete, the stream fails and nothing is consumed, not even the prefix.
+
+	/// Reads a range of bytes preceded by its length stored as PrefixInt in the selected endianity, without copying it.
+	template< typename PrefixInt, Endianity endianity, typename Byte = uint8_t, REQUIRES(
+		std::is_integral<PrefixInt>::value && std::is_unsigned<PrefixInt>::value && is_byte_alike<Byte>::value
+	)>
+	span< const Byte > readLengthPrefixedView() noexcept
+	{
+		return toByteAlikeSpan< Byte >( readLengthPrefixedData< PrefixInt, endianity >() );
+	}
+
+	/// Reads a range of bytes preceded by its length stored as PrefixInt in the selected endianity.
+	/** The container (std::string, std::vector, ...) is automatically resized before copying the bytes into it. */
+	template< typename PrefixInt, Endianity endianity, typename Cont, REQUIRES(
+		std::is_integral<PrefixInt>::value && std::is_unsigned<PrefixInt>::value
+		&& is_range_of_byte_alikes<Cont>::value && has_contiguous_data<Cont>::value && is_resizable<Cont>::value
+	)>
+	bool readLengthPrefixed( Cont & cont ) noexcept
+	{
+		copyToResizable( readLengthPrefixedData< PrefixInt, endianity >(), cont );
+		return !_failed;
+	}
+
+	/// Reads a range of bytes preceded by its length in the variable-length format (LEB128), without copying it.
+	template< typename Byte = uint8_t, REQUIRES( is_byte_alike<Byte>::value ) >
+	span< const Byte > readVarLengthPrefixedView() noexcept
+	{
+		return toByteAlikeSpan< Byte >( readVarLengthPrefixedData() );
+	}
+
+	/// Reads a range of bytes preceded by its length in the variable-length format (LEB128).
+	/** The container (std::string, std::vector, ...) is automatically resized before copying the bytes into it. */
+	template< typename Cont,
+		REQUIRES( is_range_of_byte_alikes<Cont>::value && has_contiguous_data<Cont>::value && is_resizable<Cont>::value ) >
+	bool readVarLengthPrefixed( Cont & cont ) noexcept
+	{
+		copyToResizable( readVarLengthPrefixedData(), cont );
+		return !_failed;
+	}
+
 	//-- convenience operators -----------------------------------------------------------------------------------------
 
 	template< typename Byte, REQUIRES( is_byte_alike<Byte>::value ) >  // same code for char, uint8_t, std::byte, ...
@@ -539,6 +1264,12 @@ class BinaryInputStream
 		return _curPos >= _endPos;
 	}
 
+	/// Returns the part of the buffer that has been read so far.
+	const_byte_span consumedBytes() const noexcept
+	{
+		return { _begPos, _curPos };
+	}
+
 	/// Moves over specified number of bytes without returning them to the user.
 	bool skip( size_t numBytes ) noexcept
 	{
@@ -570,6 +1301,20 @@ class BinaryInputStream
 	void setFailed() noexcept     { _failed = true; }
 	void resetFailed() noexcept   { _failed = false; }
 
+ protected:
+
+	/// Constructor for subclasses that manage their own buffer and are able to refill it.
+	BinaryInputStream( const_byte_span buffer, RefillFunc refillBuffer ) noexcept
+		: _refillBuffer( refillBuffer )
+	{
+		reset( buffer );
+	}
+
+	// Moving is allowed only to subclasses, which move their buffer along. Moving a refilling stream into a plain
+	// BinaryInputStream would slice it, and the refill function would then be called with an object of a wrong type.
+	BinaryInputStream( BinaryInputStream && ) = default;
+	BinaryInputStream & operator=( BinaryInputStream && other ) = default;
+
  private:
 
 	template< typename Type >
@@ -584,11 +1329,69 @@ class BinaryInputStream
 		return checkRead( elemCount * sizeof( Element ) );
 	}
 
+	// The length of a variable-length integer is not known in advance, so make sure the longest one would fit.
+	inline void refillForVarInt() noexcept
+	{
+		constexpr size_t maxSize = max_varint_size< uint64_t >::value;
+		if (_refillBuffer && _curPos + maxSize > _endPos)
+		{
+			_refillBuffer( *this, maxSize );
+		}
+	}
+
+	// Returns the data following a length prefix and moves behind them, or an empty span if the data are incomplete.
+	template< typename PrefixInt, Endianity endianity >
+	const_byte_span readLengthPrefixedData() noexcept
+	{
+		const_byte_span data;
+		if (checkRead( sizeof( PrefixInt ) ))
+		{
+			// the prefix is consumed only together with the data, so that a refilling stream can simply retry the read
+			const size_t length = size_t( readWithEndianity< endianity, PrefixInt >( _curPos ) );
+			if (length <= std::numeric_limits< size_t >::max() - sizeof( PrefixInt ) && checkRead( sizeof( PrefixInt ) + length ))
+			{
+				data = make_span( _curPos + sizeof( PrefixInt ), length );
+				_curPos += sizeof( PrefixInt ) + length;
+			}
+			_failed = data.data() == nullptr;
+		}
+		return data;
+	}
+
+	// Same as above, but the length prefix is in the variable-length format.
+	const_byte_span readVarLengthPrefixedData() noexcept;
+
+	template< typename Byte >
+	static span< const Byte > toByteAlikeSpan( const_byte_span bytes ) noexcept
+	{
+		return make_span( reinterpret_cast< const Byte * >( bytes.data() ), bytes.size() );
+	}
+
+	template< typename Cont >
+	static void copyToResizable( const_byte_span bytes, Cont & cont ) noexcept
+	{
+		if (bytes.data())
+		{
+			cont.resize( bytes.size() );
+			if (!bytes.empty())
+				copyBytes( bytes.data(), reinterpret_cast< uint8_t * >( &*std::begin( cont ) ), bytes.size() );
+		}
+	}
+
+	// Returns the position of the null terminator of a string starting at the current position,
+	// or nullptr if there is none before the end of the data. It may refill the buffer.
+	const uint8_t * findString0End() noexcept;
+
 	// returns readSize, or 0 if we can't read that much
 	inline size_t checkRead( size_t readSize ) noexcept
 	{
+		// not _curPos + readSize, that could overflow with a size decoded from corrupted data
+		if (readSize > remaining() && _refillBuffer && !_failed)
+		{
+			_refillBuffer( *this, readSize );
+		}
 		// the _failed flag can be true already from the previous call, in that case it will stay failed
-		_failed |= _curPos + readSize > _endPos;
+		_failed |= readSize > remaining();
 		return size_t( !_failed ) * readSize;
 	}
 
@@ -602,13 +1405,19 @@ class BinaryOutputStreamLE : public BinaryOutputStream
 {
  public:
 
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	void writeInt( Int native )
 	{
 		writeLittleEndian( native );
 	}
 
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value && sizeof(Int) != 1 ) >
+	template< typename Range, REQUIRES( is_endian_serializable_range<Range>::value && has_contiguous_data<Range>::value ) >
+	void writeIntArray( const Range & array )
+	{
+		writeLittleEndianArray( array );
+	}
+
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value && sizeof(Int) != 1 ) >
 	BinaryOutputStreamLE & operator<<( Int native )
 	{
 		writeLittleEndian( native );
@@ -639,13 +1448,19 @@ class BinaryOutputStreamBE : public BinaryOutputStream
 {
  public:
 
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	void writeInt( Int native )
 	{
 		writeBigEndian( native );
 	}
 
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value && sizeof(Int) != 1 ) >
+	template< typename Range, REQUIRES( is_endian_serializable_range<Range>::value && has_contiguous_data<Range>::value ) >
+	void writeIntArray( const Range & array )
+	{
+		writeBigEndianArray( array );
+	}
+
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value && sizeof(Int) != 1 ) >
 	BinaryOutputStreamBE & operator<<( Int native )
 	{
 		writeBigEndian( native );
@@ -676,19 +1491,31 @@ class BinaryInputStreamLE : public BinaryInputStream
 {
  public:
 
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	bool readInt( Int & native ) noexcept
 	{
 		return readLittleEndian( native );
 	}
 
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	Int readInt() noexcept
 	{
 		return readLittleEndian< Int >();
 	}
 
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value && sizeof(Int) != 1 ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
+	bool readIntArray( span< Int > array ) noexcept
+	{
+		return readLittleEndianArray( array );
+	}
+
+	template< typename Cont, REQUIRES( is_endian_serializable_range<Cont>::value && has_contiguous_data<Cont>::value ) >
+	bool readIntArray( Cont & cont ) noexcept
+	{
+		return readLittleEndianArray( cont );
+	}
+
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value && sizeof(Int) != 1 ) >
 	BinaryInputStream & operator>>( Int & native )
 	{
 		readLittleEndian( native );
@@ -726,19 +1553,31 @@ class BinaryInputStreamBE : public BinaryInputStream
 {
  public:
 
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	bool readInt( Int & native ) noexcept
 	{
 		return readBigEndian( native );
 	}
 
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
 	Int readInt() noexcept
 	{
 		return readBigEndian< Int >();
 	}
 
-	template< typename Int, REQUIRES( is_int_or_enum<Int>::value && sizeof(Int) != 1 ) >
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value ) >
+	bool readIntArray( span< Int > array ) noexcept
+	{
+		return readBigEndianArray( array );
+	}
+
+	template< typename Cont, REQUIRES( is_endian_serializable_range<Cont>::value && has_contiguous_data<Cont>::value ) >
+	bool readIntArray( Cont & cont ) noexcept
+	{
+		return readBigEndianArray( cont );
+	}
+
+	template< typename Int, REQUIRES( is_endian_serializable<Int>::value && sizeof(Int) != 1 ) >
 	BinaryInputStreamBE & operator>>( Int & native )
 	{
 		readBigEndian( native );
@@ -773,6 +1612,155 @@ BinaryInputStreamBE & BinaryInputStream::getBigEndianStream()
 }
 
 
+//======================================================================================================================
+namespace impl {
+
+/// Allocator adaptor that default-initializes the elements constructed without arguments instead of value-initializing
+/// them, so that enlarging a vector of bytes doesn't fill the new bytes with zeros that are overwritten anyway.
+template< typename Allocator >
+class DefaultInitAllocator : public Allocator
+{
+	using traits = std::allocator_traits< Allocator >;
+
+ public:
+
+	template< typename Other >
+	struct rebind
+	{
+		using other = DefaultInitAllocator< typename traits::template rebind_alloc< Other > >;
+	};
+
+	DefaultInitAllocator() = default;
+	DefaultInitAllocator( const Allocator & allocator ) noexcept : Allocator( allocator ) {}
+	template< typename Other >
+	DefaultInitAllocator( const DefaultInitAllocator< Other > & other ) noexcept : Allocator( static_cast< const Other & >( other ) ) {}
+
+	template< typename Elem >
+	void construct( Elem * ptr ) noexcept( std::is_nothrow_default_constructible< Elem >::value )
+	{
+		::new( static_cast< void * >( ptr ) ) Elem;
+	}
+	template< typename Elem, typename ... Args >
+	void construct( Elem * ptr, Args && ... args )
+	{
+		traits::construct( static_cast< Allocator & >( *this ), ptr, std::forward< Args >( args ) ... );
+	}
+};
+
+} // namespace impl
+
+
+/// Binary output stream that owns its buffer and enlarges it whenever the written data don't fit.
+/** Use this when the size of the output is not known in advance. The buffer grows geometrically, so the amortized
+  * cost of a write stays constant. When you are done writing, take the data out using release(). */
+
+template< typename Allocator = std::allocator< uint8_t > >
+class GrowingBinaryOutputStream : public BinaryOutputStream
+{
+
+ public:
+
+	/// Vector holding the data, the allocator adaptor only prevents zeroing the newly allocated capacity.
+	using buffer_type = std::vector< uint8_t, impl::DefaultInitAllocator< Allocator > >;
+
+ private:
+
+	buffer_type _buffer;  ///< the whole allocated storage, size() is the capacity of the stream
+
+ public:
+
+	/// Capacity allocated by the first write, if no initial capacity was specified.
+	static constexpr size_t c_minCapacity = 64;
+
+	explicit GrowingBinaryOutputStream( size_t initialCapacity = 0, const Allocator & allocator = Allocator() )
+		: BinaryOutputStream( byte_span(), &grow ), _buffer( typename buffer_type::allocator_type( allocator ) )
+	{
+		reserve( initialCapacity );
+	}
+
+	GrowingBinaryOutputStream( GrowingBinaryOutputStream && other )
+		: BinaryOutputStream( byte_span(), &grow ), _buffer( std::move( other._buffer ) )
+	{
+		adoptBuffer( other.offset() );
+		other.clearBuffer();
+	}
+
+	GrowingBinaryOutputStream & operator=( GrowingBinaryOutputStream && other )
+	{
+		if (this != &other)
+		{
+			const size_t otherOffset = other.offset();
+			_buffer = std::move( other._buffer );
+			adoptBuffer( otherOffset );
+			other.clearBuffer();
+		}
+		return *this;
+	}
+
+	/// Makes sure that at least \p capacity bytes in total can be written without re-allocating the buffer.
+	void reserve( size_t capacity )
+	{
+		if (capacity > _buffer.size())
+		{
+			const size_t writtenSize = offset();
+			_buffer.resize( capacity );
+			adoptBuffer( writtenSize );
+		}
+	}
+
+	/// Moves the position back to the beginning, but keeps the allocated buffer for next use.
+	void clear() noexcept
+	{
+		_curPos = _begPos;
+	}
+
+	/// Returns how many bytes can be written in total before the buffer needs to be re-allocated.
+	size_t capacity() const noexcept
+	{
+		return _buffer.size();
+	}
+
+	/// Hands over the written data to the caller without copying them and leaves the stream empty.
+	buffer_type release()
+	{
+		_buffer.resize( offset() );  // shrinking never re-allocates
+		buffer_type data( std::move( _buffer ) );
+		clearBuffer();
+		return data;
+	}
+
+ private:
+
+	using BinaryOutputStream::reset;  // this stream must never point to a buffer it doesn't own
+
+	void adoptBuffer( size_t writtenSize ) noexcept
+	{
+		_begPos = _buffer.data();
+		_curPos = _begPos + writtenSize;
+		_endPos = _begPos + _buffer.size();
+	}
+
+	void clearBuffer() noexcept
+	{
+		_buffer.clear();
+		adoptBuffer( 0 );
+	}
+
+	static void grow( BinaryOutputStream & base, size_t requiredSize )
+	{
+		auto & self = static_cast< GrowingBinaryOutputStream & >( base );
+		const size_t writtenSize = self.offset();
+		const size_t newCapacity = std::max( { writtenSize + requiredSize, 2 * self._buffer.size(), c_minCapacity } );
+		self._buffer.resize( newCapacity );
+		self.adoptBuffer( writtenSize );
+	}
+
+};
+
+template< typename Allocator >
+constexpr size_t GrowingBinaryOutputStream< Allocator >::c_minCapacity;
+
+
 //======================================================================================================================
 // misc utils
 
@@ -0,0 +1,350 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: streams for serialization of data packed at bit granularity
+//======================================================================================================================
+
+#ifndef CPPUTILS_BIT_STREAM_INCLUDED
+#define CPPUTILS_BIT_STREAM_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "BinaryStream.hpp"
+#include "Endianity.hpp"
+#include "Span.hpp"
+#include "SafetyChecks.hpp"
+
+
+namespace own {
+
+
+//======================================================================================================================
+// common definitions
+
+/// Order in which the bits are packed into bytes.
+enum class BitOrder
+{
+	MsbFirst,  ///< the first bit goes to the most significant bit of the first byte (network protocols, JPEG, H.264)
+	LsbFirst,  ///< the first bit goes to the least significant bit of the first byte (DEFLATE, most LZ-based formats)
+};
+
+namespace impl {
+
+inline uint64_t lowBitsMask( unsigned int numBits ) noexcept
+{
+	return numBits < 64 ? (uint64_t(1) << numBits) - 1 : ~uint64_t(0);
+}
+
+} // namespace impl
+
+
+//======================================================================================================================
+/// Output stream writing numbers of arbitrary bit width, packed without any padding.
+/** The bits are collected in a 64-bit accumulator and written to the underlying BinaryOutputStream a whole word at once.
+  * Multi-bit values are written from their most significant bit in the MsbFirst mode and from their least significant
+  * bit in the LsbFirst mode, so that they are read back unchanged by BitInputStream of the same order.
+  * Overflowing the underlying stream is handled by the underlying stream.
+  *
+  * WARNING: The bits that don't fill a whole word stay in the accumulator until flush() is called.
+  * flush() must be called before the underlying stream or its buffer is used, it is not called by the destructor. */
+
+template< BitOrder order >
+class BitOutputStream
+{
+
+	BinaryOutputStream & _stream;
+	uint64_t _accumulator;  ///< bits not yet written to the underlying stream, stored from the side of the bit order
+	unsigned int _numBits;  ///< number of valid bits in the accumulator, always lower than 64
+
+ public:
+
+	/// Bits are appended to whatever has already been written to the stream.
+	/** WARNING: The class takes non-owning reference to the stream.
+	  * You are responsible for making sure the stream exists at least as long as this object. */
+	explicit BitOutputStream( BinaryOutputStream & stream ) noexcept
+		: _stream( stream ), _accumulator( 0 ), _numBits( 0 ) {}
+
+	BitOutputStream( const BitOutputStream & ) = delete;
+	BitOutputStream & operator=( const BitOutputStream & ) = delete;
+
+	/// Writes the lowest \p numBits bits of \p value, the higher bits are ignored.
+	void writeBits( uint64_t value, unsigned int numBits )
+	{
+		SAFETY_CHECK( numBits <= 64, "Attempted to write more than 64 bits at once" );
+		if (numBits == 0)
+			return;
+		value &= impl::lowBitsMask( numBits );
+
+		const unsigned int freeBits = 64 - _numBits;
+		if (numBits < freeBits)
+		{
+			append( value, numBits );
+		}
+		else  // the accumulator gets full
+		{
+			const unsigned int overflowBits = numBits - freeBits;
+			if (order == BitOrder::MsbFirst)
+			{
+				// overflowBits < 64, because freeBits > 0
+				_accumulator |= value >> overflowBits;
+				writeWord();
+				_accumulator = overflowBits ? value << (64 - overflowBits) : 0;
+			}
+			else
+			{
+				_accumulator |= value << _numBits;
+				writeWord();
+				_accumulator = overflowBits ? value >> freeBits : 0;
+			}
+			_numBits = overflowBits;
+		}
+	}
+
+	void writeBit( bool bit )
+	{
+		writeBits( uint64_t( bit ), 1 );
+	}
+
+	/// Pads the current byte with zero bits, so that the next bits start at a byte boundary.
+	void alignToByte()
+	{
+		const unsigned int paddingBits = (8 - _numBits % 8) % 8;
+		if (paddingBits)
+			writeBits( 0, paddingBits );
+	}
+
+	/// Pads the current byte with zero bits and writes all the remaining bits to the underlying stream.
+	void flush()
+	{
+		alignToByte();
+		for (unsigned int byteIdx = 0; byteIdx < _numBits / 8; ++byteIdx)
+		{
+			const unsigned int shift = order == BitOrder::MsbFirst ? 56 - byteIdx * 8 : byteIdx * 8;
+			_stream.put( uint8_t( _accumulator >> shift ) );
+		}
+		_accumulator = 0;
+		_numBits = 0;
+	}
+
+	/// Returns the number of bits written so far that are not yet in the underlying stream.
+	unsigned int pendingBits() const noexcept
+	{
+		return _numBits;
+	}
+
+ private:
+
+	// the caller makes sure the bits fit
+	void append( uint64_t value, unsigned int numBits ) noexcept
+	{
+		if (order == BitOrder::MsbFirst)
+			_accumulator |= value << (64 - _numBits - numBits);
+		else
+			_accumulator |= value << _numBits;
+		_numBits += numBits;
+	}
+
+	void writeWord()
+	{
+		if (order == BitOrder::MsbFirst)
+			_stream.writeBigEndian( _accumulator );
+		else
+			_stream.writeLittleEndian( _accumulator );
+	}
+
+};
+
+
+//======================================================================================================================
+/// Input stream reading numbers of arbitrary bit width, packed without any padding.
+/** The bits are loaded into a 64-bit accumulator a whole word at once, and only the last few bytes of the buffer
+  * are loaded one by one. The error handling is the same as in BinaryInputStream: If an attempt to read past
+  * the end of the buffer is made, the stream sets its internal error flag and returns zeros for any further
+  * read operations. The error flag can be checked with failed(). */
+
+template< BitOrder order >
+class BitInputStream
+{
+
+	const uint8_t * _curPos;  ///< position in the buffer right after the bytes loaded into the accumulator
+	const uint8_t * _endPos;  ///< position of the end of the buffer
+	uint64_t _accumulator;  ///< loaded bits not yet consumed, stored from the side of the bit order
+	unsigned int _numBits;  ///< number of loaded bits not yet consumed
+	bool _failed;  ///< the end was reached while attemting to read from the buffer
+
+ public:
+
+	/// Maximum number of bits that can be read by a single peekBits().
+	static constexpr unsigned int c_maxPeekBits = 56;
+
+	/// Initializes a bit input stream operating over any byte container with continuous memory.
+	/** WARNING: The class takes non-owning reference to a buffer.
+	  * You are responsible for making sure the buffer exists at least as long as this object. */
+	explicit BitInputStream( const_byte_span buffer ) noexcept
+		: _curPos( buffer.data() ), _endPos( buffer.data() + buffer.size() ), _accumulator( 0 ), _numBits( 0 ),
+		  _failed( false ) {}
+
+	/// Returns the next \p numBits bits without consuming them.
+	/** Unlike reads, peeking past the end of the buffer doesn't fail, the missing bits are zeros.
+	  * This allows peeking a fixed number of bits when decoding variable-length codes near the end of the data. */
+	uint64_t peekBits( unsigned int numBits )
+	{
+		SAFETY_CHECK( numBits <= c_maxPeekBits, "Attempted to peek more than c_maxPeekBits bits at once" );
+		if (numBits == 0)
+			return 0;
+		refill();
+		const uint64_t value = order == BitOrder::MsbFirst
+			? _accumulator >> (64 - numBits)
+			: _accumulator & impl::lowBitsMask( numBits );
+		// the accumulator may contain bits loaded ahead of the valid ones, they are not valid past the end
+		return numBits <= _numBits ? value : maskValid( value, numBits );
+	}
+
+	/// Reads \p numBits bits (up to 64) and returns them in the lowest bits of the result.
+	uint64_t readBits( unsigned int numBits )
+	{
+		SAFETY_CHECK( numBits <= 64, "Attempted to read more than 64 bits at once" );
+		if (numBits > c_maxPeekBits)  // doesn't fit into the accumulator together with a partially consumed byte
+		{
+			if (order == BitOrder::MsbFirst)
+			{
+				const uint64_t high = readBits( numBits - 32 );
+				return (high << 32) | readBits( 32 );
+			}
+			else
+			{
+				const uint64_t low = readBits( 32 );
+				return low | (readBits( numBits - 32 ) << 32);
+			}
+		}
+		if (numBits == 0)
+			return 0;
+
+		refill();
+		_failed |= numBits > _numBits;
+		if (_failed)
+			return 0;
+
+		uint64_t value;
+		if (order == BitOrder::MsbFirst)
+		{
+			value = _accumulator >> (64 - numBits);
+			_accumulator <<= numBits;
+		}
+		else
+		{
+			value = _accumulator & impl::lowBitsMask( numBits );
+			_accumulator >>= numBits;
+		}
+		_numBits -= numBits;
+		return value;
+	}
+
+	bool readBit() noexcept
+	{
+		return readBits( 1 ) != 0;
+	}
+
+	/// Moves over specified number of bits without returning them to the user.
+	bool skipBits( size_t numBits ) noexcept
+	{
+		if (numBits > _numBits)
+		{
+			// drop everything loaded, skip the whole bytes directly in the buffer, and then the rest of the bits
+			numBits -= _numBits;
+			_accumulator = 0;
+			_numBits = 0;
+			const size_t numBytes = numBits / 8;
+			_failed |= numBytes > size_t( _endPos - _curPos );
+			if (_failed)
+				return false;
+			_curPos += numBytes;
+			numBits %= 8;
+		}
+		readBits( unsigned( numBits ) );
+		return !_failed;
+	}
+
+	/// Skips the rest of the current byte, so that the next bits are read from a byte boundary.
+	void alignToByte() noexcept
+	{
+		// the bytes are always loaded whole, so the unconsumed bits of a partially read byte are those above a multiple of 8
+		readBits( _numBits % 8 );
+	}
+
+	/// Returns how many bits can still be read.
+	size_t remainingBits() const noexcept
+	{
+		return _numBits + size_t( _endPos - _curPos ) * 8;
+	}
+
+	/// Returns true when all the bits have been read.
+	bool isAtEnd() const noexcept
+	{
+		return remainingBits() == 0;
+	}
+
+	//-- error handling ------------------------------------------------------------------------------------------------
+
+	bool failed() const noexcept  { return _failed; }
+	void setFailed() noexcept     { _failed = true; }
+	void resetFailed() noexcept   { _failed = false; }
+
+ private:
+
+	// Loads as many whole bytes into the accumulator as fit in, so that at least c_maxPeekBits + 1 bits are available
+	// unless the buffer ends.
+	void refill() noexcept
+	{
+		if (_numBits > c_maxPeekBits)
+			return;
+
+		if (_endPos - _curPos >= 8)
+		{
+			// Load the whole next word and keep only the whole bytes. The bits of the following partial byte end up below
+			// the valid bits, at the same positions where they will be loaded by the next refill, so they don't hurt.
+			if (order == BitOrder::MsbFirst)
+				_accumulator |= readBigEndian< uint64_t >( _curPos ) >> _numBits;
+			else
+				_accumulator |= readLittleEndian< uint64_t >( _curPos ) << _numBits;
+			const unsigned int numBytes = (64 - _numBits) / 8;
+			_curPos += numBytes;
+			_numBits += numBytes * 8;
+		}
+		else
+		{
+			// the last few bytes of the buffer, where a whole word can't be loaded
+			for (; _numBits <= c_maxPeekBits && _curPos < _endPos; ++_curPos, _numBits += 8)
+			{
+				if (order == BitOrder::MsbFirst)
+					_accumulator |= uint64_t( *_curPos ) << (56 - _numBits);
+				else
+					_accumulator |= uint64_t( *_curPos ) << _numBits;
+			}
+		}
+	}
+
+	// Clears the bits of a peeked value that lie past the end of the data.
+	uint64_t maskValid( uint64_t value, unsigned int numBits ) const noexcept
+	{
+		if (order == BitOrder::MsbFirst)
+			return value & ~impl::lowBitsMask( numBits - _numBits );
+		else
+			return value & impl::lowBitsMask( _numBits );
+	}
+
+};
+
+template< BitOrder order >
+constexpr unsigned int BitInputStream< order >::c_maxPeekBits;
+
+
+//======================================================================================================================
+
+
+} // namespace own
+
+
+#endif // CPPUTILS_BIT_STREAM_INCLUDED
@@ -0,0 +1,227 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: incremental checksums and their computation over binary streams
+//======================================================================================================================
+
+#include "Checksum.hpp"
+
+#include "MemAccessUtils.hpp"
+#include "CpuFeatures.hpp"
+
+#include <algorithm>  // min
+#include <atomic>
+
+#if defined(CPPUTILS_X86)
+	#include <immintrin.h>
+#endif
+
+
+namespace own {
+
+
+//======================================================================================================================
+// CRC-32C
+
+// Tables for processing 8 bytes at once, table k contains the CRC of a byte followed by k zero bytes.
+struct Crc32cTables
+{
+	uint32_t t [8][256];
+
+	Crc32cTables() noexcept
+	{
+		constexpr uint32_t reversedPolynomial = 0x82F63B78;
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; ++bit)
+				crc = (crc >> 1) ^ (reversedPolynomial & (0 - (crc & 1)));
+			t[0][i] = crc;
+		}
+		for (uint32_t i = 0; i < 256; ++i)
+			for (size_t k = 1; k < 8; ++k)
+				t[k][i] = (t[k-1][i] >> 8) ^ t[0][ t[k-1][i] & 0xFF ];
+	}
+};
+
+static const Crc32cTables & crc32cTables() noexcept
+{
+	static const Crc32cTables tables;  // initialized on the first use
+	return tables;
+}
+
+static uint32_t crc32c_scalar( uint32_t crc, const uint8_t * pos, const uint8_t * end ) noexcept
+{
+	const auto & t = crc32cTables().t;
+	for (; end - pos >= 8; pos += 8)
+	{
+		crc ^= readLittleEndian< uint32_t >( pos );
+		crc = t[7][ crc & 0xFF ] ^ t[6][ (crc >> 8) & 0xFF ] ^ t[5][ (crc >> 16) & 0xFF ] ^ t[4][ crc >> 24 ]
+		    ^ t[3][ pos[4] ] ^ t[2][ pos[5] ] ^ t[1][ pos[6] ] ^ t[0][ pos[7] ];
+	}
+	for (; pos < end; ++pos)
+		crc = t[0][ (crc ^ *pos) & 0xFF ] ^ (crc >> 8);
+	return crc;
+}
+
+#if defined(CPPUTILS_X86)
+
+TARGET_ISA("sse4.2")
+static uint32_t crc32c_sse42( uint32_t crc, const uint8_t * pos, const uint8_t * end ) noexcept
+{
+ #if defined(__x86_64__) || defined(_M_X64)
+	for (; end - pos >= 8; pos += 8)
+		crc = uint32_t( _mm_crc32_u64( crc, readLittleEndian< uint64_t >( pos ) ) );
+ #endif
+	for (; end - pos >= 4; pos += 4)
+		crc = _mm_crc32_u32( crc, readLittleEndian< uint32_t >( pos ) );
+	for (; pos < end; ++pos)
+		crc = _mm_crc32_u8( crc, *pos );
+	return crc;
+}
+
+#endif // CPPUTILS_X86
+
+static std::atomic< decltype( &crc32c_scalar ) > g_crc32cKernel( crc32c_scalar );
+
+// The crc32 instruction is not part of any SimdLevel, it's used whenever the CPU has it,
+// unless the kernels are restricted to the scalar ones.
+static void bindKernels( SimdLevel level ) noexcept
+{
+ #if defined(CPPUTILS_X86)
+	if (cpuFeatures().sse42 && level != SimdLevel::Scalar)
+	{
+		g_crc32cKernel.store( crc32c_sse42, std::memory_order_relaxed );
+		return;
+	}
+ #endif
+	g_crc32cKernel.store( crc32c_scalar, std::memory_order_relaxed );
+}
+
+static impl::KernelBinder g_kernelBinder( bindKernels );
+
+void Crc32c::update( const_byte_span data ) noexcept
+{
+	_state = g_crc32cKernel.load( std::memory_order_relaxed )( _state, data.begin(), data.end() );
+}
+
+
+//======================================================================================================================
+// xxHash64
+
+static constexpr uint64_t xxPrime1 = 11400714785074694791ULL;
+static constexpr uint64_t xxPrime2 = 14029467366897019727ULL;
+static constexpr uint64_t xxPrime3 = 1609587929392839161ULL;
+static constexpr uint64_t xxPrime4 = 9650029242287828579ULL;
+static constexpr uint64_t xxPrime5 = 2870177450012600261ULL;
+
+static inline uint64_t rotateLeft( uint64_t value, unsigned int numBits ) noexcept
+{
+	return (value << numBits) | (value >> (64 - numBits));
+}
+
+static inline uint64_t xxRound( uint64_t lane, uint64_t input ) noexcept
+{
+	return rotateLeft( lane + input * xxPrime2, 31 ) * xxPrime1;
+}
+
+static inline uint64_t xxMergeLane( uint64_t hash, uint64_t lane ) noexcept
+{
+	return (hash ^ xxRound( 0, lane )) * xxPrime1 + xxPrime4;
+}
+
+// processes whole 32-byte stripes and returns the position after the last one
+static const uint8_t * xxConsumeStripes( uint64_t (& lanes) [4], const uint8_t * pos, const uint8_t * end ) noexcept
+{
+	// the 4 lanes are independent, so the CPU can process them in parallel
+	for (; end - pos >= 32; pos += 32)
+	{
+		lanes[0] = xxRound( lanes[0], readLittleEndian< uint64_t >( pos ) );
+		lanes[1] = xxRound( lanes[1], readLittleEndian< uint64_t >( pos + 8 ) );
+		lanes[2] = xxRound( lanes[2], readLittleEndian< uint64_t >( pos + 16 ) );
+		lanes[3] = xxRound( lanes[3], readLittleEndian< uint64_t >( pos + 24 ) );
+	}
+	return pos;
+}
+
+void XxHash64::reset( uint64_t seed ) noexcept
+{
+	_seed = seed;
+	_lanes[0] = seed + xxPrime1 + xxPrime2;
+	_lanes[1] = seed + xxPrime2;
+	_lanes[2] = seed;
+	_lanes[3] = seed - xxPrime1;
+	_stripeSize = 0;
+	_totalSize = 0;
+}
+
+void XxHash64::update( const_byte_span data ) noexcept
+{
+	if (data.empty())
+		return;
+
+	const uint8_t * pos = data.begin();
+	const uint8_t * const end = data.end();
+	_totalSize += data.size();
+
+	if (_stripeSize > 0)  // complete the stripe started by the previous update
+	{
+		const size_t copySize = std::min( sizeof( _stripe ) - _stripeSize, data.size() );
+		copyBytes( pos, _stripe + _stripeSize, copySize );
+		_stripeSize += copySize;
+		pos += copySize;
+		if (_stripeSize < sizeof( _stripe ))
+			return;
+		xxConsumeStripes( _lanes, _stripe, _stripe + sizeof( _stripe ) );
+		_stripeSize = 0;
+	}
+
+	pos = xxConsumeStripes( _lanes, pos, end );
+
+	_stripeSize = size_t( end - pos );
+	copyBytes( pos, _stripe, _stripeSize );
+}
+
+uint64_t XxHash64::value() const noexcept
+{
+	uint64_t hash;
+	if (_totalSize >= sizeof( _stripe ))
+	{
+		hash = rotateLeft( _lanes[0], 1 ) + rotateLeft( _lanes[1], 7 ) + rotateLeft( _lanes[2], 12 ) + rotateLeft( _lanes[3], 18 );
+		for (uint64_t lane : _lanes)
+			hash = xxMergeLane( hash, lane );
+	}
+	else
+	{
+		hash = _seed + xxPrime5;
+	}
+	hash += _totalSize;
+
+	// the rest that doesn't fill a whole stripe
+	const uint8_t * pos = _stripe;
+	const uint8_t * const end = _stripe + _stripeSize;
+	for (; end - pos >= 8; pos += 8)
+		hash = rotateLeft( hash ^ xxRound( 0, readLittleEndian< uint64_t >( pos ) ), 27 ) * xxPrime1 + xxPrime4;
+	if (end - pos >= 4)
+	{
+		hash = rotateLeft( hash ^ (uint64_t( readLittleEndian< uint32_t >( pos ) ) * xxPrime1), 23 ) * xxPrime2 + xxPrime3;
+		pos += 4;
+	}
+	for (; pos < end; ++pos)
+		hash = rotateLeft( hash ^ (*pos * xxPrime5), 11 ) * xxPrime1;
+
+	// final avalanche
+	hash ^= hash >> 33;
+	hash *= xxPrime2;
+	hash ^= hash >> 29;
+	hash *= xxPrime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace own
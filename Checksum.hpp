@@ -0,0 +1,252 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: incremental checksums and their computation over binary streams
+//======================================================================================================================
+
+#ifndef CPPUTILS_CHECKSUM_INCLUDED
+#define CPPUTILS_CHECKSUM_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "Span.hpp"
+#include "Endianity.hpp"
+#include "BinaryStream.hpp"
+
+
+namespace own {
+
+
+// All the checksum classes have the same interface, so that they can be used interchangeably in the stream adapters:
+//   using value_type = ...;                 type of the resulting checksum
+//   void update( const_byte_span data );    adds more data to the checksum
+//   value_type value() const;               returns the checksum of all the data added so far
+//   void reset();                           starts a new checksum
+
+
+//======================================================================================================================
+/// CRC-32C (Castagnoli), as used in iSCSI, SCTP, ext4, LevelDB, ...
+/** Uses the crc32 instruction when the CPU supports SSE4.2, otherwise a table-driven "slicing-by-8" algorithm. */
+
+class Crc32c
+{
+
+	uint32_t _state;
+
+ public:
+
+	using value_type = uint32_t;
+
+	Crc32c() noexcept : _state( ~uint32_t(0) ) {}
+
+	void update( const_byte_span data ) noexcept;
+
+	value_type value() const noexcept
+	{
+		return ~_state;
+	}
+
+	void reset() noexcept
+	{
+		_state = ~uint32_t(0);
+	}
+
+	/// Computes the checksum of a single continuous block of data.
+	static value_type compute( const_byte_span data ) noexcept
+	{
+		Crc32c crc;
+		crc.update( data );
+		return crc.value();
+	}
+
+};
+
+
+//======================================================================================================================
+/// 64-bit variant of the xxHash non-cryptographic hash function.
+/** Much faster than CRC on CPUs without the crc32 instruction, but it doesn't have the error detection guarantees
+  * of CRC. */
+
+class XxHash64
+{
+
+	uint64_t _seed;
+	uint64_t _lanes [4];  ///< accumulators of the 4 parallel lanes
+	uint8_t _stripe [32];  ///< data that don't fill a whole stripe yet
+	size_t _stripeSize;  ///< number of bytes in _stripe
+	uint64_t _totalSize;
+
+ public:
+
+	using value_type = uint64_t;
+
+	explicit XxHash64( uint64_t seed = 0 ) noexcept
+	{
+		reset( seed );
+	}
+
+	void update( const_byte_span data ) noexcept;
+
+	value_type value() const noexcept;
+
+	void reset() noexcept
+	{
+		reset( _seed );
+	}
+
+	void reset( uint64_t seed ) noexcept;
+
+	/// Computes the hash of a single continuous block of data.
+	static value_type compute( const_byte_span data, uint64_t seed = 0 ) noexcept
+	{
+		XxHash64 hash( seed );
+		hash.update( data );
+		return hash.value();
+	}
+
+};
+
+
+//======================================================================================================================
+/// Computes a checksum of the data written into a BinaryOutputStream, without a second pass over the finished buffer.
+/** The data are hashed directly in the buffer of the stream. It happens in update(), so that it can be called
+  * periodically (e.g. after each record) to hash the data while they are still in the CPU cache.
+  * The checksum covers the data written after the construction of this object or after the last reset().
+  * Only the streams writing into a single continuous buffer are supported (not SegmentedBinaryOutputStream). */
+
+template< typename Checksum >
+class OutputChecksum
+{
+
+	BinaryOutputStream & _stream;
+	Checksum _checksum;
+	size_t _hashedOffset;  ///< offset in the stream up to which the data are already hashed
+
+ public:
+
+	using value_type = typename Checksum::value_type;
+
+	/// WARNING: The class takes non-owning reference to the stream.
+	/// You are responsible for making sure the stream exists at least as long as this object.
+	explicit OutputChecksum( BinaryOutputStream & stream, Checksum checksum = Checksum() ) noexcept
+		: _stream( stream ), _checksum( checksum ), _hashedOffset( stream.offset() ) {}
+
+	/// Adds the data written since the last update to the checksum.
+	void update() noexcept
+	{
+		const_byte_span written = _stream.writtenBytes();
+		if (written.size() > _hashedOffset)  // the stream may have been cleared
+		{
+			_checksum.update( make_span( written.data() + _hashedOffset, written.end() ) );
+			_hashedOffset = written.size();
+		}
+	}
+
+	/// Returns the checksum of all the data written so far.
+	value_type currentChecksum() noexcept
+	{
+		update();
+		return _checksum.value();
+	}
+
+	/// Appends the checksum of all the data written so far to the stream.
+	/** The checksum itself is not included in the checksum. */
+	template< Endianity endianity >
+	void writeChecksum()
+	{
+		const value_type checksum = currentChecksum();
+		if (endianity == Endianity::Big)
+			_stream.writeBigEndian( checksum );
+		else
+			_stream.writeLittleEndian( checksum );
+		_hashedOffset = _stream.offset();
+	}
+
+	/// Starts a new checksum from the current position in the stream.
+	void reset() noexcept
+	{
+		_checksum.reset();
+		_hashedOffset = _stream.offset();
+	}
+
+};
+
+
+//======================================================================================================================
+/// Computes a checksum of the data read from a BinaryInputStream, without a second pass over the input buffer.
+/** The data are hashed directly in the buffer of the stream. It happens in update(), so that it can be called
+  * periodically (e.g. after each record) to hash the data while they are still in the CPU cache.
+  * The checksum covers the data consumed after the construction of this object or after the last reset().
+  * Only the streams reading from a single continuous buffer are supported (not RefillingBinaryInputStream). */
+
+template< typename Checksum >
+class InputChecksum
+{
+
+	BinaryInputStream & _stream;
+	Checksum _checksum;
+	size_t _hashedOffset;  ///< offset in the stream up to which the data are already hashed
+
+ public:
+
+	using value_type = typename Checksum::value_type;
+
+	/// WARNING: The class takes non-owning reference to the stream.
+	/// You are responsible for making sure the stream exists at least as long as this object.
+	explicit InputChecksum( BinaryInputStream & stream, Checksum checksum = Checksum() ) noexcept
+		: _stream( stream ), _checksum( checksum ), _hashedOffset( stream.offset() ) {}
+
+	/// Adds the data consumed since the last update to the checksum.
+	void update() noexcept
+	{
+		const_byte_span consumed = _stream.consumedBytes();
+		if (consumed.size() > _hashedOffset)  // the stream may have been rewound
+		{
+			_checksum.update( make_span( consumed.data() + _hashedOffset, consumed.end() ) );
+			_hashedOffset = consumed.size();
+		}
+	}
+
+	/// Returns the checksum of all the data consumed so far.
+	value_type currentChecksum() noexcept
+	{
+		update();
+		return _checksum.value();
+	}
+
+	/// Reads a checksum from the stream and compares it with the checksum of all the data consumed before it.
+	/** If they don't match, the stream is marked as failed. */
+	template< Endianity endianity >
+	bool readAndVerify() noexcept
+	{
+		const value_type checksum = currentChecksum();
+		const value_type expected = endianity == Endianity::Big
+			? _stream.readBigEndian< value_type >()
+			: _stream.readLittleEndian< value_type >();
+		_hashedOffset = _stream.offset();
+		if (checksum != expected)
+		{
+			_stream.setFailed();
+		}
+		return !_stream.failed();
+	}
+
+	/// Starts a new checksum from the current position in the stream.
+	void reset() noexcept
+	{
+		_checksum.reset();
+		_hashedOffset = _stream.offset();
+	}
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace own
+
+
+#endif // CPPUTILS_CHECKSUM_INCLUDED
@@ -0,0 +1,209 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: run-time detection of CPU features and selection of vectorized kernels
+//======================================================================================================================
+
+#include "CpuFeatures.hpp"
+
+#include <atomic>
+#include <mutex>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>  // __cpuidex, _xgetbv
+#elif defined(CPPUTILS_X86)
+	#include <cpuid.h>  // __cpuid_count
+#endif
+
+
+namespace own {
+
+
+//======================================================================================================================
+// feature detection
+
+#if defined(CPPUTILS_X86)
+
+struct CpuidRegs
+{
+	uint32_t eax, ebx, ecx, edx;
+};
+
+static CpuidRegs cpuid( uint32_t leaf, uint32_t subleaf = 0 ) noexcept
+{
+	CpuidRegs regs;
+ #if defined(_MSC_VER)
+	int values [4];
+	__cpuidex( values, int( leaf ), int( subleaf ) );
+	regs.eax = uint32_t( values[0] );
+	regs.ebx = uint32_t( values[1] );
+	regs.ecx = uint32_t( values[2] );
+	regs.edx = uint32_t( values[3] );
+ #else
+	__cpuid_count( leaf, subleaf, regs.eax, regs.ebx, regs.ecx, regs.edx );
+ #endif
+	return regs;
+}
+
+// returns which register states the operating system saves on context switch
+static uint64_t enabledRegisterStates() noexcept
+{
+ #if defined(_MSC_VER)
+	return _xgetbv( 0 );
+ #else
+	// the intrinsic would require compiling with -mxsave
+	uint32_t eax, edx;
+	__asm__( "xgetbv" : "=a"( eax ), "=d"( edx ) : "c"( 0 ) );
+	return (uint64_t( edx ) << 32) | eax;
+ #endif
+}
+
+static bool isBitSet( uint32_t reg, unsigned int bitIdx ) noexcept
+{
+	return (reg >> bitIdx) & 1;
+}
+
+static CpuFeatures detectCpuFeatures() noexcept
+{
+	CpuFeatures features;
+
+	const uint32_t maxLeaf = cpuid( 0 ).eax;
+	if (maxLeaf < 1)
+		return features;
+
+	const CpuidRegs leaf1 = cpuid( 1 );
+	features.sse2 = isBitSet( leaf1.edx, 26 );
+	features.ssse3 = isBitSet( leaf1.ecx, 9 );
+	features.sse42 = isBitSet( leaf1.ecx, 20 );
+
+	// The CPU may support AVX, but if the operating system doesn't save the upper halves of the vector registers,
+	// using them would corrupt the registers of other threads.
+	const bool hasXgetbv = isBitSet( leaf1.ecx, 27 );  // OSXSAVE
+	const uint64_t registerStates = hasXgetbv ? enabledRegisterStates() : 0;
+	const bool ymmEnabled = (registerStates & 0x06) == 0x06;  // SSE + AVX state
+	const bool zmmEnabled = (registerStates & 0xE6) == 0xE6;  // + opmask + upper halves of ZMM0-15 + ZMM16-31
+	const bool hasAvx = isBitSet( leaf1.ecx, 28 ) && ymmEnabled;
+
+	if (maxLeaf >= 7)
+	{
+		const CpuidRegs leaf7 = cpuid( 7, 0 );
+		features.avx2 = hasAvx && isBitSet( leaf7.ebx, 5 );
+		features.avx512bw = zmmEnabled && isBitSet( leaf7.ebx, 16 ) && isBitSet( leaf7.ebx, 30 );  // AVX512F + AVX512BW
+	}
+
+	return features;
+}
+
+#else
+
+static CpuFeatures detectCpuFeatures() noexcept
+{
+	return CpuFeatures();
+}
+
+#endif // CPPUTILS_X86
+
+const CpuFeatures & cpuFeatures() noexcept
+{
+	static const CpuFeatures features = detectCpuFeatures();
+	return features;
+}
+
+
+//======================================================================================================================
+// kernel selection
+
+SimdLevel maxSimdLevel() noexcept
+{
+	const CpuFeatures & features = cpuFeatures();
+	// AVX2 without SSSE3 doesn't exist, but let's not rely on it
+	if (features.avx2 && features.ssse3)
+		return SimdLevel::AVX2;
+	else if (features.ssse3 && features.sse2)
+		return SimdLevel::SSSE3;
+	else if (features.sse2)
+		return SimdLevel::SSE2;
+	else
+		return SimdLevel::Scalar;
+}
+
+// Function-local static, so that it's initialized before the first use, even when the kernels are used
+// by constructors of other global objects.
+static std::atomic< SimdLevel > & currentSimdLevel() noexcept
+{
+	static std::atomic< SimdLevel > level( maxSimdLevel() );
+	return level;
+}
+
+SimdLevel simdLevel() noexcept
+{
+	return currentSimdLevel().load( std::memory_order_relaxed );
+}
+
+void setSimdLevel( SimdLevel level ) noexcept
+{
+	const SimdLevel maxLevel = maxSimdLevel();
+	if (level > maxLevel)
+		level = maxLevel;
+	currentSimdLevel().store( level, std::memory_order_relaxed );
+	impl::KernelBinder::bindAll( level );
+}
+
+void resetSimdLevel() noexcept
+{
+	setSimdLevel( maxSimdLevel() );
+}
+
+
+//======================================================================================================================
+// kernel binding
+
+namespace impl {
+
+// Function-local statics for the same reason as the level, the binders are constructed during the dynamic
+// initialization of other source files.
+static std::mutex & bindersMutex() noexcept
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+static KernelBinder * & firstBinder() noexcept
+{
+	static KernelBinder * first = nullptr;
+	return first;
+}
+
+KernelBinder::KernelBinder( BindFunc bindKernels ) noexcept
+	: _bindKernels( bindKernels )
+{
+	std::lock_guard< std::mutex > lock( bindersMutex() );
+	_bindKernels( simdLevel() );
+	_next = firstBinder();
+	firstBinder() = this;
+}
+
+KernelBinder::~KernelBinder()
+{
+	std::lock_guard< std::mutex > lock( bindersMutex() );
+	KernelBinder * * link = &firstBinder();
+	while (*link != this)
+		link = &(*link)->_next;
+	*link = _next;
+}
+
+void KernelBinder::bindAll( SimdLevel level ) noexcept
+{
+	std::lock_guard< std::mutex > lock( bindersMutex() );
+	for (KernelBinder * binder = firstBinder(); binder; binder = binder->_next)
+		binder->_bindKernels( level );
+}
+
+} // namespace impl
+
+
+//======================================================================================================================
+
+
+} // namespace own
@@ -0,0 +1,142 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: run-time detection of CPU features and selection of vectorized kernels
+//======================================================================================================================
+
+#ifndef CPPUTILS_CPU_FEATURES_INCLUDED
+#define CPPUTILS_CPU_FEATURES_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <atomic>
+
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define CPPUTILS_X86
+#endif
+
+// Allows compiling a single function for an instruction set that is not enabled for the whole build.
+// Such function may only be called after checking that the CPU supports the instruction set.
+// MSVC allows using any intrinsics without it.
+#if defined(CPPUTILS_X86) && defined(__GNUC__)  // gcc or clang
+	#define TARGET_ISA( isa ) __attribute__(( target( isa ) ))
+#else
+	#define TARGET_ISA( isa )
+#endif
+
+// Initializer of a kernel table indexed by SimdLevel. On other architectures than x86, the vectorized variants
+// don't exist, and the scalar one is used for all the levels.
+#if defined(CPPUTILS_X86)
+	#define SIMD_KERNEL_TABLE( scalar, sse2, ssse3, avx2 ) { scalar, sse2, ssse3, avx2 }
+#else
+	#define SIMD_KERNEL_TABLE( scalar, sse2, ssse3, avx2 ) { scalar, scalar, scalar, scalar }
+#endif
+
+
+namespace own {
+
+
+//======================================================================================================================
+// feature detection
+
+/// Instruction set extensions supported by the CPU and enabled by the operating system.
+struct CpuFeatures
+{
+	bool sse2 = false;
+	bool ssse3 = false;
+	bool sse42 = false;
+	bool avx2 = false;
+	bool avx512bw = false;
+};
+
+/// Returns the features of the CPU this program runs on.
+/** They are detected with the cpuid instruction on the first call, and then the result is reused.
+  * On other architectures than x86, all of them are false. */
+const CpuFeatures & cpuFeatures() noexcept;
+
+
+//======================================================================================================================
+// kernel selection
+
+/// Instruction sets the vectorized kernels in this library are compiled for, each level includes the previous ones.
+enum class SimdLevel : uint8_t
+{
+	Scalar,
+	SSE2,
+	SSSE3,
+	AVX2,
+};
+
+constexpr size_t c_numSimdLevels = size_t( SimdLevel::AVX2 ) + 1;
+
+/// Returns the highest level supported by the CPU this program runs on.
+SimdLevel maxSimdLevel() noexcept;
+
+/// Returns the level of the kernels that are currently used.
+/** By default it's maxSimdLevel(). */
+SimdLevel simdLevel() noexcept;
+
+/// Makes all the kernels use the given level, for example to test or benchmark all of their variants on a single machine.
+/** A level higher than maxSimdLevel() is lowered to it, so that an unsupported instruction is never executed.
+  * It is shared by all the threads, and should be changed only while no other thread uses the kernels. */
+void setSimdLevel( SimdLevel level ) noexcept;
+
+/// Returns back to the level selected automatically according to the CPU.
+void resetSimdLevel() noexcept;
+
+
+//======================================================================================================================
+// private implementation details
+
+namespace impl {
+
+// The public functions call their kernel through an atomic pointer, so that a call costs only one relaxed load
+// and an indirect call. The pointers are constant-initialized to the scalar variant, so they are usable even
+// by constructors of global objects that run before the vectorized variants are bound.
+
+/// Points \p kernel to the variant for \p level from a table initialized by SIMD_KERNEL_TABLE.
+template< typename Func >
+void bindKernel( std::atomic< Func > & kernel, Func const (& kernels) [c_numSimdLevels], SimdLevel level ) noexcept
+{
+	kernel.store( kernels[ size_t( level ) ], std::memory_order_relaxed );
+}
+
+/// Keeps the kernel pointers of a source file bound to the current SimdLevel.
+/** Define one as a static object next to the kernel pointers. Its constructor binds them for the current level,
+  * and setSimdLevel() or resetSimdLevel() calls the bind function again with the new level. */
+class KernelBinder
+{
+
+ public:
+
+	using BindFunc = void (*)( SimdLevel level );
+
+	explicit KernelBinder( BindFunc bindKernels ) noexcept;
+	~KernelBinder();
+
+	KernelBinder( const KernelBinder & ) = delete;
+	KernelBinder & operator=( const KernelBinder & ) = delete;
+
+	/// Binds the kernels of all the existing binders for the given level.
+	static void bindAll( SimdLevel level ) noexcept;
+
+ private:
+
+	BindFunc _bindKernels;
+	KernelBinder * _next;  ///< the binders form a linked list, so that registering them never allocates
+
+};
+
+} // namespace impl
+
+
+//======================================================================================================================
+
+
+} // namespace own
+
+
+#endif // CPPUTILS_CPU_FEATURES_INCLUDED
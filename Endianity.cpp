@@ -0,0 +1,169 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: types and functions dealing with endianity
+//======================================================================================================================
+
+#include "Endianity.hpp"
+
+#include "CpuFeatures.hpp"
+
+#if defined(CPPUTILS_X86)
+	#include <immintrin.h>
+#endif
+
+
+namespace own {
+namespace impl {
+
+
+//======================================================================================================================
+// array conversion
+
+template< size_t elemSize >
+static void copyByteSwapped_scalar( const uint8_t * src, uint8_t * dst, size_t count ) noexcept
+{
+	using UInt = typename uint_of_size< elemSize >::type;
+	for (size_t offset = 0; offset < count * elemSize; offset += elemSize)
+	{
+		// the whole element is loaded before it's stored, so the in-place conversion works too
+		writeIntDirectly_unaligned( dst + offset, byteSwap( readIntDirectly_unaligned< UInt >( src + offset ) ) );
+	}
+}
+
+#if defined(CPPUTILS_X86)
+
+// index of the source byte that goes to position i when reversing the bytes of each element
+static constexpr char swappedByteIdx( size_t elemSize, size_t i ) noexcept
+{
+	return char( i / elemSize * elemSize + (elemSize - 1 - i % elemSize) );
+}
+
+template< size_t elemSize >
+TARGET_ISA("ssse3")
+static inline __m128i byteSwapMask() noexcept
+{
+	return _mm_setr_epi8(
+		swappedByteIdx( elemSize, 0 ),  swappedByteIdx( elemSize, 1 ),  swappedByteIdx( elemSize, 2 ),  swappedByteIdx( elemSize, 3 ),
+		swappedByteIdx( elemSize, 4 ),  swappedByteIdx( elemSize, 5 ),  swappedByteIdx( elemSize, 6 ),  swappedByteIdx( elemSize, 7 ),
+		swappedByteIdx( elemSize, 8 ),  swappedByteIdx( elemSize, 9 ),  swappedByteIdx( elemSize, 10 ), swappedByteIdx( elemSize, 11 ),
+		swappedByteIdx( elemSize, 12 ), swappedByteIdx( elemSize, 13 ), swappedByteIdx( elemSize, 14 ), swappedByteIdx( elemSize, 15 )
+	);
+}
+
+// The vectorized variants leave the rest that doesn't fill a whole vector to the narrower variants.
+
+template< size_t elemSize >
+TARGET_ISA("ssse3")
+static void copyByteSwapped_ssse3( const uint8_t * src, uint8_t * dst, size_t count ) noexcept
+{
+	const size_t totalSize = count * elemSize;
+	const __m128i mask = byteSwapMask< elemSize >();
+	size_t offset = 0;
+	for (; offset + 16 <= totalSize; offset += 16)
+	{
+		const __m128i data = _mm_loadu_si128( reinterpret_cast< const __m128i * >( src + offset ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + offset ), _mm_shuffle_epi8( data, mask ) );
+	}
+	copyByteSwapped_scalar< elemSize >( src + offset, dst + offset, count - offset / elemSize );
+}
+
+template< size_t elemSize >
+TARGET_ISA("avx2")
+static void copyByteSwapped_avx2( const uint8_t * src, uint8_t * dst, size_t count ) noexcept
+{
+	const size_t totalSize = count * elemSize;
+	// the shuffle works within 128-bit lanes, so both lanes use the same mask
+	const __m256i mask = _mm256_broadcastsi128_si256( byteSwapMask< elemSize >() );
+	size_t offset = 0;
+	for (; offset + 32 <= totalSize; offset += 32)
+	{
+		const __m256i data = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( src + offset ) );
+		_mm256_storeu_si256( reinterpret_cast< __m256i * >( dst + offset ), _mm256_shuffle_epi8( data, mask ) );
+	}
+	copyByteSwapped_ssse3< elemSize >( src + offset, dst + offset, count - offset / elemSize );
+}
+
+#endif // CPPUTILS_X86
+
+// pointer to the variant bound for the current SimdLevel, one for each element size
+template< size_t elemSize >
+struct ByteSwapKernel
+{
+	static std::atomic< decltype( &copyByteSwapped_scalar< elemSize > ) > current;
+
+	static void bind( SimdLevel level ) noexcept
+	{
+		static decltype( &copyByteSwapped_scalar< elemSize > ) const kernels [] = SIMD_KERNEL_TABLE(
+			copyByteSwapped_scalar< elemSize >, copyByteSwapped_scalar< elemSize >,
+			copyByteSwapped_ssse3< elemSize >, copyByteSwapped_avx2< elemSize >
+		);
+		bindKernel( current, kernels, level );
+	}
+};
+
+template< size_t elemSize >
+std::atomic< decltype( &copyByteSwapped_scalar< elemSize > ) > ByteSwapKernel< elemSize >::current(
+	copyByteSwapped_scalar< elemSize >
+);
+
+template< size_t elemSize >
+static void copyByteSwapped_sized( const uint8_t * src, uint8_t * dst, size_t count ) noexcept
+{
+	// arrays that don't fill a single vector are not worth the indirect call
+	if (count * elemSize < 16)
+		copyByteSwapped_scalar< elemSize >( src, dst, count );
+	else
+		ByteSwapKernel< elemSize >::current.load( std::memory_order_relaxed )( src, dst, count );
+}
+
+void copyByteSwapped( const uint8_t * src, uint8_t * dst, size_t elemSize, size_t count ) noexcept
+{
+	switch (elemSize)
+	{
+		case 1:
+			if (src != dst)
+				copyBytes( src, dst, count );
+			break;
+		case 2:
+			copyByteSwapped_sized< 2 >( src, dst, count );
+			break;
+		case 4:
+			copyByteSwapped_sized< 4 >( src, dst, count );
+			break;
+		case 8:
+			copyByteSwapped_sized< 8 >( src, dst, count );
+			break;
+ #ifdef CPPUTILS_HAS_INT128
+		case 16:
+			copyByteSwapped_sized< 16 >( src, dst, count );
+			break;
+ #endif
+		default:
+			break;  // unreachable through the public API, there are no numbers of other sizes
+	}
+}
+
+
+//======================================================================================================================
+// kernel binding
+
+static void bindKernels( SimdLevel level ) noexcept
+{
+	ByteSwapKernel< 2 >::bind( level );
+	ByteSwapKernel< 4 >::bind( level );
+	ByteSwapKernel< 8 >::bind( level );
+ #ifdef CPPUTILS_HAS_INT128
+	ByteSwapKernel< 16 >::bind( level );
+ #endif
+}
+
+static KernelBinder g_kernelBinder( bindKernels );
+
+
+//======================================================================================================================
+
+
+} // namespace impl
+} // namespace own
@@ -14,6 +14,15 @@
 #include "TypeTraits.hpp"  // REQUIRES
 #include "MemAccessUtils.hpp"
 
+#include <cstring>  // memcpy
+
+#if __cplusplus > 202002L  // C++23
+	#include <bit>  // byteswap
+#endif
+#if defined(_MSC_VER)
+	#include <stdlib.h>  // _byteswap_*
+#endif
+
 
 namespace own {
 
@@ -73,105 +82,111 @@ constexpr Endianity c_thisCpuEndianity
 
 
 //======================================================================================================================
-// integer conversion - private implementation details
+// byte order reversal - private implementation details
 
 namespace impl {
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value && sizeof(Type) != 1 ) >
-inline void writeConvertedLittleEndian( uint8_t * const bufferPos, Type native ) noexcept
-{
-	using IntType = typename int_type< Type >::type;
-	IntType nativeInt = IntType( native );
+// The compilers recognize the shifting idiom only with optimizations enabled and not always,
+// so we use the intrinsics directly, they compile to a single instruction (bswap, rev, ...).
 
-	// indexed variant is more optimizable than variant with pointers https://godbolt.org/z/McT3Yb
-	size_t offset = 0;
-	while (offset < sizeof( nativeInt )) {
-		bufferPos[ offset ] = uint8_t( nativeInt & 0xFF );
-		nativeInt >>= 8;
-		++offset;
-	}
+inline uint8_t byteSwap( uint8_t value ) noexcept
+{
+	return value;
 }
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value && sizeof(Type) != 1 ) >
-inline void writeConvertedBigEndian( uint8_t * const bufferPos, Type native ) noexcept
+inline uint16_t byteSwap( uint16_t value ) noexcept
 {
-	using IntType = typename int_type< Type >::type;
-	IntType nativeInt = IntType( native );
-
-	// indexed variant is more optimizable than variant with pointers https://godbolt.org/z/McT3Yb
-	size_t offset = sizeof( nativeInt );
-	while (offset > 0) {  // can't use traditional for-loop approach, because index is unsigned
-		--offset;         // so we can't check if it's < 0
-		bufferPos[ offset ] = uint8_t( nativeInt & 0xFF );
-		nativeInt >>= 8;
-	}
+ #if defined(__cpp_lib_byteswap)
+	return std::byteswap( value );
+ #elif defined(__GNUC__)
+	return __builtin_bswap16( value );
+ #elif defined(_MSC_VER)
+	return _byteswap_ushort( value );
+ #else
+	return uint16_t( (value >> 8) | (value << 8) );
+ #endif
 }
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value && sizeof(Type) != 1 ) >
-inline Type readConvertedLittleEndian( const uint8_t * const bufferPos ) noexcept
+inline uint32_t byteSwap( uint32_t value ) noexcept
 {
-	using IntType = typename int_type< Type >::type;
-	IntType nativeInt = 0;
-
-	// indexed variant is more optimizable than variant with pointers https://godbolt.org/z/McT3Yb
-	size_t offset = sizeof( IntType );
-	while (offset > 0) {  // can't use traditional for-loop approach, because index is unsigned
-		--offset;         // so we can't check if it's < 0
-		nativeInt <<= 8;
-		nativeInt = IntType( nativeInt | bufferPos[ offset ] );
-	}
-
-	return Type( nativeInt );
+ #if defined(__cpp_lib_byteswap)
+	return std::byteswap( value );
+ #elif defined(__GNUC__)
+	return __builtin_bswap32( value );
+ #elif defined(_MSC_VER)
+	return _byteswap_ulong( value );
+ #else
+	value = ((value & 0xFF00FF00) >> 8) | ((value & 0x00FF00FF) << 8);
+	return (value >> 16) | (value << 16);
+ #endif
 }
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value && sizeof(Type) != 1 ) >
-inline Type readConvertedBigEndian( const uint8_t * const bufferPos ) noexcept
+inline uint64_t byteSwap( uint64_t value ) noexcept
 {
-	using IntType = typename int_type< Type >::type;
-	IntType nativeInt = 0;
-
-	// indexed variant is more optimizable than variant with pointers https://godbolt.org/z/McT3Yb
-	size_t pos = 0;
-	while (pos < sizeof( IntType )) {
-		nativeInt <<= 8;
-		nativeInt = IntType( nativeInt | bufferPos[ pos ] );
-		++pos;
-	}
-
-	return Type( nativeInt );
+ #if defined(__cpp_lib_byteswap)
+	return std::byteswap( value );
+ #elif defined(__GNUC__)
+	return __builtin_bswap64( value );
+ #elif defined(_MSC_VER)
+	return _byteswap_uint64( value );
+ #else
+	value = ((value & 0xFF00FF00FF00FF00) >> 8) | ((value & 0x00FF00FF00FF00FF) << 8);
+	value = ((value & 0xFFFF0000FFFF0000) >> 16) | ((value & 0x0000FFFF0000FFFF) << 16);
+	return (value >> 32) | (value << 32);
+ #endif
 }
 
-// It is useful to provide these functions for all integer sizes, for possible generic code that doesn't know the type.
-// But if the Type is single-byte, shift by 8 is undefined, so we need to have separate overloads.
-
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value && sizeof(Type) == 1 ) >
-inline void writeConvertedLittleEndian( uint8_t * const bufferPos, Type native ) noexcept
+#ifdef CPPUTILS_HAS_INT128
+inline uint128 byteSwap( uint128 value ) noexcept
 {
-	*bufferPos = uint8_t( native );
+	const uint64_t lowHalf = uint64_t( value );
+	const uint64_t highHalf = uint64_t( value >> 64 );
+	return (uint128( byteSwap( lowHalf ) ) << 64) | byteSwap( highHalf );
 }
+#endif
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value && sizeof(Type) == 1 ) >
-inline void writeConvertedBigEndian( uint8_t * const bufferPos, Type native ) noexcept
+/// Returns the bit representation of a number as an unsigned integer of the same size.
+template< typename Type >
+inline typename uint_of_size< sizeof( Type ) >::type toUIntBits( Type value ) noexcept
 {
-	*bufferPos = uint8_t( native );
+	typename uint_of_size< sizeof( Type ) >::type bits;
+	std::memcpy( &bits, &value, sizeof( value ) );  // the only portable way of bit-casting before C++20
+	return bits;
 }
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value && sizeof(Type) == 1 ) >
-inline Type readConvertedLittleEndian( const uint8_t * const bufferPos ) noexcept
+/// Reinterprets bits stored in an unsigned integer as a number of different type of the same size.
+template< typename Type >
+inline Type fromUIntBits( typename uint_of_size< sizeof( Type ) >::type bits ) noexcept
 {
-	return Type( *bufferPos );
+	Type value;
+	std::memcpy( &value, &bits, sizeof( value ) );
+	return value;
 }
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value && sizeof(Type) == 1 ) >
-inline Type readConvertedBigEndian( const uint8_t * const bufferPos ) noexcept
+} // namespace impl
+
+
+//======================================================================================================================
+// byte order reversal - public API
+
+/// Reverses the order of bytes of an arbitrary integral number.
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value && !std::is_floating_point<Type>::value ) >
+inline Type byteSwap( Type value ) noexcept
 {
-	return Type( *bufferPos );
+	using UInt = typename uint_of_size< sizeof( Type ) >::type;
+	return Type( impl::byteSwap( UInt( value ) ) );
 }
 
+
+//======================================================================================================================
+// number conversion - private implementation details
+
+namespace impl {
+
 // Direct write and read optimizations in case the target endianity equals to the current endianity.
 // The best compilers can do this automatically, but not under all circumstances. This way we are sure.
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value ) >
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
 inline void writeIntDirectly_unaligned( uint8_t * bufferPos, Type native ) noexcept
 {
 	Type toWrite = native;
@@ -182,13 +197,13 @@ inline void writeIntDirectly_unaligned( uint8_t * bufferPos, Type native ) noexc
 	);
 }
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value ) >
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
 inline void writeIntDirectly_aligned( uint8_t * bufferPos, Type native ) noexcept
 {
 	*reinterpret_cast< Type * >( bufferPos ) = native;
 }
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value ) >
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
 inline Type readIntDirectly_unaligned( const uint8_t * bufferPos ) noexcept
 {
 	Type toRead;
@@ -196,33 +211,65 @@ inline Type readIntDirectly_unaligned( const uint8_t * bufferPos ) noexcept
 	return toRead;
 }
 
-template< typename Type, REQUIRES( is_int_or_enum<Type>::value ) >
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
 inline Type readIntDirectly_aligned( const uint8_t * bufferPos ) noexcept
 {
 	return *reinterpret_cast< const Type * >( bufferPos );
 }
 
 
+// Conversion to the opposite endianity by loading the number as it is and swapping its bytes afterwards
+// (or the other way around). This is a lot faster than composing the number byte by byte.
+// The bytes are swapped in the integer representation, because a floating point number with swapped bytes
+// may not survive being passed around (signaling NaNs can be silently modified).
+
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+inline void writeIntSwapped_unaligned( uint8_t * bufferPos, Type native ) noexcept
+{
+	writeIntDirectly_unaligned( bufferPos, byteSwap( toUIntBits( native ) ) );
+}
+
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+inline void writeIntSwapped_aligned( uint8_t * bufferPos, Type native ) noexcept
+{
+	writeIntDirectly_aligned( bufferPos, byteSwap( toUIntBits( native ) ) );
+}
+
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+inline Type readIntSwapped_unaligned( const uint8_t * bufferPos ) noexcept
+{
+	using UInt = typename uint_of_size< sizeof( Type ) >::type;
+	return fromUIntBits< Type >( byteSwap( readIntDirectly_unaligned< UInt >( bufferPos ) ) );
+}
+
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+inline Type readIntSwapped_aligned( const uint8_t * bufferPos ) noexcept
+{
+	using UInt = typename uint_of_size< sizeof( Type ) >::type;
+	return fromUIntBits< Type >( byteSwap( readIntDirectly_aligned< UInt >( bufferPos ) ) );
+}
+
+
 } // namespace impl
 
 
 //======================================================================================================================
-// integer conversion - public API
+// number conversion - public API
 // NOTE: The following functions perform no boundary checking, caller must ensure there is enough space in the buffer
 //       to do the read or write. Preffer using BinaryStream.h whenever possible.
 
-/// Converts an arbitrary integral number from native format to little endian and writes it into the buffer.
+/// Converts an arbitrary number from native format to little endian and writes it into the buffer.
 template< typename Type >
 inline void writeLittleEndian( uint8_t * bufferPos, Type native ) noexcept
 {
  #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_LITTLE_ENDIAN
 	impl::writeIntDirectly_unaligned( bufferPos, native );
  #else
-	impl::writeConvertedLittleEndian( bufferPos, native );
+	impl::writeIntSwapped_unaligned( bufferPos, native );
  #endif
 }
 
-/// Converts an arbitrary integral number from native format to little endian and writes it into the buffer.
+/// Converts an arbitrary number from native format to little endian and writes it into the buffer.
 /** Variant manually optimized for cases where the \p bufferPos is divisible by sizeof(Type) */
 template< typename Type >
 inline void writeLittleEndian_aligned( uint8_t * bufferPos, Type native ) noexcept
@@ -230,77 +277,196 @@ inline void writeLittleEndian_aligned( uint8_t * bufferPos, Type native ) noexce
  #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_LITTLE_ENDIAN
 	impl::writeIntDirectly_aligned( bufferPos, native );
  #else
-	impl::writeConvertedLittleEndian( bufferPos, native );
+	impl::writeIntSwapped_aligned( bufferPos, native );
  #endif
 }
 
-/// Converts an arbitrary integral number from native format to big endian and writes it into the buffer.
+/// Converts an arbitrary number from native format to big endian and writes it into the buffer.
 template< typename Type >
 inline void writeBigEndian( uint8_t * bufferPos, Type native ) noexcept
 {
  #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_BIG_ENDIAN
 	impl::writeIntDirectly_unaligned( bufferPos, native );
  #else
-	impl::writeConvertedBigEndian( bufferPos, native );
+	impl::writeIntSwapped_unaligned( bufferPos, native );
  #endif
 }
 
-/// Converts an arbitrary integral number from native format to big endian and writes it into the buffer.
+/// Converts an arbitrary number from native format to big endian and writes it into the buffer.
 template< typename Type >
 inline void writeBigEndian_aligned( uint8_t * bufferPos, Type native ) noexcept
 {
  #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_BIG_ENDIAN
 	impl::writeIntDirectly_aligned( bufferPos, native );
  #else
-	impl::writeConvertedBigEndian( bufferPos, native );
+	impl::writeIntSwapped_aligned( bufferPos, native );
  #endif
 }
 
-/// Reads an arbitrary integral number from the buffer and converts it from little endian to native format.
+/// Reads an arbitrary number from the buffer and converts it from little endian to native format.
 template< typename Type >
 inline Type readLittleEndian( const uint8_t * bufferPos ) noexcept
 {
  #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_LITTLE_ENDIAN
 	return impl::readIntDirectly_unaligned< Type >( bufferPos );
  #else
-	return impl::readConvertedLittleEndian< Type >( bufferPos );
+	return impl::readIntSwapped_unaligned< Type >( bufferPos );
  #endif
 }
 
-/// Reads an arbitrary integral number from the buffer and converts it from little endian to native format.
+/// Reads an arbitrary number from the buffer and converts it from little endian to native format.
 template< typename Type >
 inline Type readLittleEndian_aligned( const uint8_t * bufferPos ) noexcept
 {
  #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_LITTLE_ENDIAN
 	return impl::readIntDirectly_aligned< Type >( bufferPos );
  #else
-	return impl::readConvertedLittleEndian< Type >( bufferPos );
+	return impl::readIntSwapped_aligned< Type >( bufferPos );
  #endif
 }
 
-/// Reads an arbitrary integral number from the buffer and converts it from big endian to native format.
+/// Reads an arbitrary number from the buffer and converts it from big endian to native format.
 template< typename Type >
 inline Type readBigEndian( const uint8_t * bufferPos ) noexcept
 {
  #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_BIG_ENDIAN
 	return impl::readIntDirectly_unaligned< Type >( bufferPos );
  #else
-	return impl::readConvertedBigEndian< Type >( bufferPos );
+	return impl::readIntSwapped_unaligned< Type >( bufferPos );
  #endif
 }
 
-/// Reads an arbitrary integral number from the buffer and converts it from big endian to native format.
+/// Reads an arbitrary number from the buffer and converts it from big endian to native format.
 template< typename Type >
 inline Type readBigEndian_aligned( const uint8_t * bufferPos ) noexcept
 {
  #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_BIG_ENDIAN
 	return impl::readIntDirectly_aligned< Type >( bufferPos );
  #else
-	return impl::readConvertedBigEndian< Type >( bufferPos );
+	return impl::readIntSwapped_aligned< Type >( bufferPos );
+ #endif
+}
+
+
+/// Converts an arbitrary number from native format to the selected endianity and writes it into the buffer.
+/** Useful for generic code, where the endianity is a template parameter. */
+template< Endianity endianity, typename Type >
+inline void writeWithEndianity( uint8_t * bufferPos, Type native ) noexcept
+{
+	if (endianity == Endianity::Little)
+		writeLittleEndian( bufferPos, native );
+	else
+		writeBigEndian( bufferPos, native );
+}
+
+/// Reads an arbitrary number from the buffer and converts it from the selected endianity to native format.
+/** Useful for generic code, where the endianity is a template parameter. */
+template< Endianity endianity, typename Type >
+inline Type readWithEndianity( const uint8_t * bufferPos ) noexcept
+{
+	if (endianity == Endianity::Little)
+		return readLittleEndian< Type >( bufferPos );
+	else
+		return readBigEndian< Type >( bufferPos );
+}
+
+
+//======================================================================================================================
+// array conversion - private implementation details
+
+namespace impl {
+
+/// Copies \p count elements of size \p elemSize from \p src to \p dst while reversing the byte order of each element.
+/** Supported element sizes are 1, 2, 4, 8 and 16. The ranges must either be the same or not overlap at all.
+  * Uses SSSE3 or AVX2 byte shuffles when the CPU supports them. */
+void copyByteSwapped( const uint8_t * src, uint8_t * dst, size_t elemSize, size_t count ) noexcept;
+
+} // namespace impl
+
+
+//======================================================================================================================
+// array conversion - public API
+// NOTE: The following functions perform no boundary checking, caller must ensure there is enough space in the buffer
+//       to do the read or write. Preffer using BinaryStream.h whenever possible.
+
+/// Converts an array of numbers from native format to little endian and writes it into the buffer.
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+inline void writeLittleEndianArray( uint8_t * bufferPos, const Type * native, size_t count ) noexcept
+{
+ #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_LITTLE_ENDIAN
+	copyBytes( reinterpret_cast< const uint8_t * >( native ), bufferPos, count * sizeof( Type ) );
+ #else
+	if (sizeof( Type ) == 1)  // nothing to swap
+		copyBytes( reinterpret_cast< const uint8_t * >( native ), bufferPos, count );
+	else
+		impl::copyByteSwapped( reinterpret_cast< const uint8_t * >( native ), bufferPos, sizeof( Type ), count );
+ #endif
+}
+
+/// Converts an array of numbers from native format to big endian and writes it into the buffer.
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+inline void writeBigEndianArray( uint8_t * bufferPos, const Type * native, size_t count ) noexcept
+{
+ #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_BIG_ENDIAN
+	copyBytes( reinterpret_cast< const uint8_t * >( native ), bufferPos, count * sizeof( Type ) );
+ #else
+	if (sizeof( Type ) == 1)  // nothing to swap
+		copyBytes( reinterpret_cast< const uint8_t * >( native ), bufferPos, count );
+	else
+		impl::copyByteSwapped( reinterpret_cast< const uint8_t * >( native ), bufferPos, sizeof( Type ), count );
+ #endif
+}
+
+/// Reads an array of numbers from the buffer and converts them from little endian to native format.
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+inline void readLittleEndianArray( const uint8_t * bufferPos, Type * native, size_t count ) noexcept
+{
+ #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_LITTLE_ENDIAN
+	copyBytes( bufferPos, reinterpret_cast< uint8_t * >( native ), count * sizeof( Type ) );
+ #else
+	if (sizeof( Type ) == 1)  // nothing to swap
+		copyBytes( bufferPos, reinterpret_cast< uint8_t * >( native ), count );
+	else
+		impl::copyByteSwapped( bufferPos, reinterpret_cast< uint8_t * >( native ), sizeof( Type ), count );
+ #endif
+}
+
+/// Reads an array of numbers from the buffer and converts them from big endian to native format.
+template< typename Type, REQUIRES( is_endian_serializable<Type>::value ) >
+inline void readBigEndianArray( const uint8_t * bufferPos, Type * native, size_t count ) noexcept
+{
+ #if CPPUTILS_THIS_CPU_ENDIANITY == CPPUTILS_BIG_ENDIAN
+	copyBytes( bufferPos, reinterpret_cast< uint8_t * >( native ), count * sizeof( Type ) );
+ #else
+	if (sizeof( Type ) == 1)  // nothing to swap
+		copyBytes( bufferPos, reinterpret_cast< uint8_t * >( native ), count );
+	else
+		impl::copyByteSwapped( bufferPos, reinterpret_cast< uint8_t * >( native ), sizeof( Type ), count );
  #endif
 }
 
 
+/// Converts an array of numbers from native format to the selected endianity and writes it into the buffer.
+template< Endianity endianity, typename Type >
+inline void writeArrayWithEndianity( uint8_t * bufferPos, const Type * native, size_t count ) noexcept
+{
+	if (endianity == Endianity::Little)
+		writeLittleEndianArray( bufferPos, native, count );
+	else
+		writeBigEndianArray( bufferPos, native, count );
+}
+
+/// Reads an array of numbers from the buffer and converts them from the selected endianity to native format.
+template< Endianity endianity, typename Type >
+inline void readArrayWithEndianity( const uint8_t * bufferPos, Type * native, size_t count ) noexcept
+{
+	if (endianity == Endianity::Little)
+		readLittleEndianArray( bufferPos, native, count );
+	else
+		readBigEndianArray( bufferPos, native, count );
+}
+
+
 //======================================================================================================================
 
 
@@ -18,6 +18,11 @@ using uint = unsigned int;
 using ushort = unsigned short;
 using ulong = unsigned long;
 using ullong = unsigned long long;
+#ifdef __SIZEOF_INT128__  // gcc and clang on 64-bit platforms
+	#define CPPUTILS_HAS_INT128
+	__extension__ typedef __int128 int128;  // __extension__ silences the pedantic warnings
+	__extension__ typedef unsigned __int128 uint128;
+#endif
 //using byte = uint8_t;
 
 using std::move;
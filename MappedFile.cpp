@@ -0,0 +1,296 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: files mapped into memory, usable directly by the binary streams
+//======================================================================================================================
+
+#include "MappedFile.hpp"
+
+#ifdef CPPUTILS_HAS_MMAP
+
+#include <algorithm>  // max, min
+#include <cerrno>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace own {
+
+
+//======================================================================================================================
+// helpers
+
+static int toMAdvice( MappedFile::AccessPattern accessPattern ) noexcept
+{
+	switch (accessPattern)
+	{
+		case MappedFile::AccessPattern::Sequential:  return MADV_SEQUENTIAL;
+		case MappedFile::AccessPattern::Random:      return MADV_RANDOM;
+		default:                                     return MADV_NORMAL;
+	}
+}
+
+// closes a file descriptor while keeping the errno of the error that caused it
+static void closePreservingErrno( int fd ) noexcept
+{
+	const int origErrno = errno;
+	::close( fd );
+	errno = origErrno;
+}
+
+
+//======================================================================================================================
+// MappedFile
+
+MappedFile::MappedFile( MappedFile && other ) noexcept
+	: _data( other._data ), _size( other._size ), _fd( other._fd ), _isOpen( other._isOpen )
+{
+	other._data = nullptr;
+	other._size = 0;
+	other._fd = -1;
+	other._isOpen = false;
+}
+
+MappedFile & MappedFile::operator=( MappedFile && other ) noexcept
+{
+	close();
+	std::swap( _data, other._data );
+	std::swap( _size, other._size );
+	std::swap( _fd, other._fd );
+	std::swap( _isOpen, other._isOpen );
+	return *this;
+}
+
+bool MappedFile::openForReading( const std::string & filePath, AccessPattern accessPattern, LoadStrategy loadStrategy )
+{
+	close();
+
+	const int fd = ::open( filePath.c_str(), O_RDONLY | O_CLOEXEC );
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat fileInfo;
+	if (::fstat( fd, &fileInfo ) != 0)
+	{
+		closePreservingErrno( fd );
+		return false;
+	}
+	const size_t fileSize = size_t( fileInfo.st_size );
+
+	// empty files can't be mapped, but they are still valid inputs
+	if (fileSize > 0)
+	{
+		int flags = MAP_PRIVATE;
+	 #ifdef MAP_POPULATE
+		if (loadStrategy == LoadStrategy::Populate)
+		{
+			flags |= MAP_POPULATE;
+			loadStrategy = LoadStrategy::Lazy;
+		}
+	 #endif
+
+		void * data = ::mmap( nullptr, fileSize, PROT_READ, flags, fd, 0 );
+		if (data == MAP_FAILED)
+		{
+			closePreservingErrno( fd );
+			return false;
+		}
+
+		// these are only hints, if they fail, the mapping is still usable
+		::madvise( data, fileSize, toMAdvice( accessPattern ) );
+		if (loadStrategy != LoadStrategy::Lazy)
+		{
+			::madvise( data, fileSize, MADV_WILLNEED );
+		}
+
+		_data = data;
+		_size = fileSize;
+	}
+
+	// the mapping stays valid even after the file is closed
+	::close( fd );
+	_isOpen = true;
+	return true;
+}
+
+bool MappedFile::openForWriting( const std::string & filePath, size_t initialSize )
+{
+	close();
+
+	_fd = ::open( filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+	if (_fd < 0)
+	{
+		return false;
+	}
+	_isOpen = true;
+
+	if (!resize( initialSize ))
+	{
+		const int origErrno = errno;
+		close();
+		errno = origErrno;
+		return false;
+	}
+	return true;
+}
+
+bool MappedFile::resize( size_t newSize )
+{
+	if (_fd < 0)
+	{
+		errno = EBADF;
+		return false;
+	}
+
+	if (newSize == _size)
+	{
+		return true;
+	}
+
+	if (::ftruncate( _fd, off_t( newSize ) ) != 0)
+	{
+		return false;
+	}
+
+	void * newData = nullptr;
+	if (newSize == 0)
+	{
+		::munmap( _data, _size );
+	}
+	else if (_data)
+	{
+	 #ifdef MREMAP_MAYMOVE
+		newData = ::mremap( _data, _size, newSize, MREMAP_MAYMOVE );
+	 #else
+		::munmap( _data, _size );
+		newData = ::mmap( nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0 );
+	 #endif
+	}
+	else
+	{
+		newData = ::mmap( nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0 );
+	}
+
+	if (newData == MAP_FAILED)
+	{
+	 #ifdef MREMAP_MAYMOVE
+		// mremap leaves the original mapping untouched, only the file needs to be restored
+		const int origErrno = errno;
+		static_cast< void >( ::ftruncate( _fd, off_t( _size ) ) == 0 );
+		errno = origErrno;
+	 #else
+		_data = nullptr;
+		_size = 0;
+	 #endif
+		return false;
+	}
+
+	_data = newData;
+	_size = newSize;
+	return true;
+}
+
+bool MappedFile::sync()
+{
+	if (!_data)
+	{
+		return true;
+	}
+	return ::msync( _data, _size, MS_SYNC ) == 0;
+}
+
+void MappedFile::close() noexcept
+{
+	if (_data)
+	{
+		::munmap( _data, _size );
+		_data = nullptr;
+	}
+	_size = 0;
+	if (_fd >= 0)
+	{
+		::close( _fd );
+		_fd = -1;
+	}
+	_isOpen = false;
+}
+
+bool MappedFile::advise( AccessPattern accessPattern, size_t offset, size_t length )
+{
+	if (!_data || offset >= _size)
+	{
+		return true;
+	}
+
+	// madvise requires the address to be aligned to the page size
+	const size_t pageSize = size_t( ::sysconf( _SC_PAGESIZE ) );
+	const size_t alignedOffset = offset - offset % pageSize;
+	const size_t alignedLength = std::min( length, _size - offset ) + (offset - alignedOffset);
+
+	return ::madvise( static_cast< uint8_t * >( _data ) + alignedOffset, alignedLength, toMAdvice( accessPattern ) ) == 0;
+}
+
+
+//======================================================================================================================
+// MappedFileOutputStream
+
+constexpr size_t MappedFileOutputStream::c_defaultChunkSize;
+
+bool MappedFileOutputStream::open( const std::string & filePath )
+{
+	close();
+
+	if (!_file.openForWriting( filePath, _chunkSize ))
+	{
+		return false;
+	}
+
+	reset( _file.writableData() );
+	return true;
+}
+
+bool MappedFileOutputStream::close()
+{
+	if (!_file.isOpen())
+	{
+		return true;
+	}
+
+	const bool truncated = _file.resize( offset() );
+	_file.close();
+	reset( byte_span() );
+	return truncated;
+}
+
+void MappedFileOutputStream::grow( BinaryOutputStream & base, size_t requiredSize )
+{
+	auto & self = static_cast< MappedFileOutputStream & >( base );
+	if (!self._file.isOpen())
+	{
+		return;  // the write will fail
+	}
+
+	const size_t writtenSize = self.offset();
+	const size_t newSize = std::max( writtenSize + requiredSize, self._file.size() + self._chunkSize );
+	if (!self._file.resize( newSize ))
+	{
+		return;  // the write will fail and report it, the reason stays in errno
+	}
+
+	self.reset( self._file.writableData() );
+	self._curPos += writtenSize;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace own
+
+#endif // CPPUTILS_HAS_MMAP
@@ -0,0 +1,165 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: files mapped into memory, usable directly by the binary streams
+//======================================================================================================================
+
+#ifndef CPPUTILS_MAPPED_FILE_INCLUDED
+#define CPPUTILS_MAPPED_FILE_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "Span.hpp"
+#include "BinaryStream.hpp"
+#include "SafetyChecks.hpp"
+
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define CPPUTILS_HAS_MMAP
+#endif
+
+
+#ifdef CPPUTILS_HAS_MMAP
+
+namespace own {
+
+
+//======================================================================================================================
+/// File mapped into the memory of this process.
+/** Reading a file this way avoids copying its content into a separate buffer, the data are loaded by the operating
+  * system directly into the page cache when they are accessed. The mapped content can be passed to BinaryInputStream.
+  * All methods returning bool report errors the same way as the POSIX functions, the reason is in errno. */
+
+class MappedFile
+{
+
+ public:
+
+	/// How the mapped data are going to be accessed, so that the system can optimize the read-ahead.
+	enum class AccessPattern
+	{
+		Normal,
+		Sequential,
+		Random,
+	};
+
+	/// When the content of the file is loaded into the memory.
+	enum class LoadStrategy
+	{
+		Lazy,      ///< each page is loaded on its first access
+		Prefetch,  ///< the system starts loading the pages in the background
+		Populate,  ///< the whole file is loaded before the mapping is returned (falls back to Prefetch if unsupported)
+	};
+
+	MappedFile() noexcept : _data( nullptr ), _size( 0 ), _fd( -1 ), _isOpen( false ) {}
+	~MappedFile()  { close(); }
+
+	MappedFile( const MappedFile & ) = delete;
+	MappedFile & operator=( const MappedFile & ) = delete;
+	MappedFile( MappedFile && other ) noexcept;
+	MappedFile & operator=( MappedFile && other ) noexcept;
+
+	/// Maps an existing file for reading.
+	bool openForReading(
+		const std::string & filePath,
+		AccessPattern accessPattern = AccessPattern::Sequential,
+		LoadStrategy loadStrategy = LoadStrategy::Lazy
+	);
+
+	/// Creates or truncates a file and maps it for writing with an initial size.
+	/** The size of the file can be changed later with resize(). */
+	bool openForWriting( const std::string & filePath, size_t initialSize = 0 );
+
+	/// Changes the size of a file opened for writing and remaps it, the mapping may move to a different address.
+	bool resize( size_t newSize );
+
+	/// Flushes the modified content of a file opened for writing to the disk.
+	bool sync();
+
+	/// Unmaps the file and closes it.
+	void close() noexcept;
+
+	bool isOpen() const noexcept      { return _isOpen; }
+	bool isWritable() const noexcept  { return _fd >= 0; }
+
+	size_t size() const noexcept  { return _size; }
+
+	/// The mapped content of the file.
+	const_byte_span data() const noexcept  { return make_span( static_cast< const uint8_t * >( _data ), _size ); }
+
+	/// The mapped content of the file, only for files opened for writing.
+	/** The pages of a file opened for reading are read-only, so for such file the span is empty. */
+	byte_span writableData()
+	{
+		SAFETY_CHECK( !_isOpen || isWritable(), "Attempted to write into a file mapped for reading" );
+		return isWritable() ? make_span( static_cast< uint8_t * >( _data ), _size ) : byte_span();
+	}
+
+	/// Gives the system a new hint about how a part of the mapped content is going to be accessed.
+	bool advise( AccessPattern accessPattern, size_t offset = 0, size_t length = size_t(-1) );
+
+ private:
+
+	void * _data;  ///< address of the mapping, nullptr if nothing is mapped (also when the file is empty)
+	size_t _size;  ///< size of the mapping
+	int _fd;  ///< kept open only for files opened for writing, -1 otherwise
+	bool _isOpen;
+
+};
+
+
+//======================================================================================================================
+/// Binary output stream writing directly into a memory-mapped file.
+/** The file is enlarged in chunks whenever the written data don't fit, and when the stream is closed,
+  * it is truncated to the size of the actually written data. If the file can't be enlarged, the write fails
+  * the same way as writing past the end of a fixed buffer, and the reason of the failure is left in errno. */
+
+class MappedFileOutputStream : public BinaryOutputStream
+{
+
+	MappedFile _file;
+	size_t _chunkSize;
+
+ public:
+
+	static constexpr size_t c_defaultChunkSize = 1024 * 1024;
+
+	explicit MappedFileOutputStream( size_t chunkSize = c_defaultChunkSize ) noexcept
+		: BinaryOutputStream( byte_span(), &grow ), _chunkSize( chunkSize ) {}
+
+	~MappedFileOutputStream()  { close(); }
+
+	MappedFileOutputStream( const MappedFileOutputStream & ) = delete;
+	MappedFileOutputStream & operator=( const MappedFileOutputStream & ) = delete;
+	MappedFileOutputStream( MappedFileOutputStream && ) = delete;
+	MappedFileOutputStream & operator=( MappedFileOutputStream && ) = delete;
+
+	/// Creates or truncates a file and prepares the stream for writing into it.
+	bool open( const std::string & filePath );
+
+	/// Truncates the file to the size of the written data and closes it.
+	bool close();
+
+	bool isOpen() const noexcept  { return _file.isOpen(); }
+
+ private:
+
+	using BinaryOutputStream::reset;  // this stream must never point to a buffer it doesn't own
+
+	static void grow( BinaryOutputStream & base, size_t requiredSize );
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace own
+
+#endif // CPPUTILS_HAS_MMAP
+
+
+#endif // CPPUTILS_MAPPED_FILE_INCLUDED
@@ -13,6 +13,10 @@
 
 #include "TypeTraits.hpp"
 
+#if defined(_MSC_VER) && !defined(__clang__)
+	#include <intrin.h>  // _BitScanForward64, _BitScanReverse64
+#endif
+
 
 namespace own {
 
@@ -25,6 +29,44 @@ constexpr Int1 div_ceil( Int1 divident, Int2 divisor )
 	return ((divident - 1) / divisor) + 1;
 }
 
+/// Returns the number of zero bits above the highest set bit. The \p value must not be 0.
+inline uint countLeadingZeros( uint64_t value ) noexcept
+{
+ #if defined(__GNUC__)
+	return uint( __builtin_clzll( value ) );
+ #elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64( &index, value );
+	return 63 - uint( index );
+ #else
+	uint count = 0;
+	while (!(value & (uint64_t(1) << 63))) {
+		value <<= 1;
+		++count;
+	}
+	return count;
+ #endif
+}
+
+/// Returns the number of zero bits below the lowest set bit. The \p value must not be 0.
+inline uint countTrailingZeros( uint64_t value ) noexcept
+{
+ #if defined(__GNUC__)
+	return uint( __builtin_ctzll( value ) );
+ #elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64( &index, value );
+	return uint( index );
+ #else
+	uint count = 0;
+	while (!(value & 1)) {
+		value >>= 1;
+		++count;
+	}
+	return count;
+ #endif
+}
+
 
 } // namespace asw::hns
 
@@ -7,11 +7,33 @@
 
 #include "MemAccessUtils.hpp"
 
+#include "MathUtils.hpp"  // countTrailingZeros, div_ceil
+#include "ThreadPool.hpp"
+#include "CpuFeatures.hpp"
+
 #include <cstring>
+#include <algorithm>  // min, max
+#include <atomic>
+
+#if defined(CPPUTILS_X86)
+	#include <immintrin.h>
+#endif
 
 
 namespace own {
 
+
+//======================================================================================================================
+// dispatching
+
+// The vectorized kernels are compiled for their instruction set even when the build doesn't enable it,
+// and the variant supported by the CPU is selected at run time from a table indexed by the current SimdLevel.
+// The selected variants are bound to the kernel pointers by bindKernels() at the end of this file.
+
+
+//======================================================================================================================
+// initialization
+
 void fillBytes_large( uint8_t * dst, size_t count, uint8_t value ) noexcept
 {
 	std::memset( dst, value, count );
@@ -22,6 +44,82 @@ void zeroBytes_large( uint8_t * dst, size_t count ) noexcept
 	std::memset( dst, 0, count );
 }
 
+// The pattern is replicated into a whole block, which is then stored at once. The block size is a multiple
+// of the pattern size, so every block starts with the beginning of the pattern.
+
+static inline void replicatePattern( uint8_t * block, size_t blockSize, const uint8_t * pattern, size_t patternSize ) noexcept
+{
+	for (size_t i = 0; i < blockSize; i += patternSize)
+	{
+		std::memcpy( block + i, pattern, patternSize );
+	}
+}
+
+static void fillPattern_scalar( uint8_t * dst, size_t count, const uint8_t * pattern, size_t patternSize ) noexcept
+{
+	uint8_t block [16];
+	replicatePattern( block, sizeof( block ), pattern, patternSize );
+
+	uint8_t * pos = dst;
+	uint8_t * const end = dst + count;
+	for (; size_t( end - pos ) >= sizeof( block ); pos += sizeof( block ))
+	{
+		std::memcpy( pos, block, sizeof( block ) );
+	}
+	std::memcpy( pos, block, size_t( end - pos ) );
+}
+
+#if defined(CPPUTILS_X86)
+
+TARGET_ISA("sse2")
+static void fillPattern_sse2( uint8_t * dst, size_t count, const uint8_t * pattern, size_t patternSize ) noexcept
+{
+	alignas( 16 ) uint8_t block [16];
+	replicatePattern( block, sizeof( block ), pattern, patternSize );
+
+	uint8_t * pos = dst;
+	uint8_t * const end = dst + count;
+	const __m128i vector = _mm_load_si128( reinterpret_cast< const __m128i * >( block ) );
+	for (; size_t( end - pos ) >= sizeof( block ); pos += sizeof( block ))
+	{
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( pos ), vector );
+	}
+	std::memcpy( pos, block, size_t( end - pos ) );
+}
+
+TARGET_ISA("avx2")
+static void fillPattern_avx2( uint8_t * dst, size_t count, const uint8_t * pattern, size_t patternSize ) noexcept
+{
+	alignas( 32 ) uint8_t block [32];
+	replicatePattern( block, sizeof( block ), pattern, patternSize );
+
+	uint8_t * pos = dst;
+	uint8_t * const end = dst + count;
+	const __m256i vector = _mm256_load_si256( reinterpret_cast< const __m256i * >( block ) );
+	for (; size_t( end - pos ) >= sizeof( block ); pos += sizeof( block ))
+	{
+		_mm256_storeu_si256( reinterpret_cast< __m256i * >( pos ), vector );
+	}
+	std::memcpy( pos, block, size_t( end - pos ) );
+}
+
+#endif // CPPUTILS_X86
+
+static std::atomic< decltype( &fillPattern_scalar ) > g_fillPatternKernel( fillPattern_scalar );
+
+namespace impl {
+
+void fillPattern( uint8_t * dst, size_t count, const uint8_t * pattern, size_t patternSize ) noexcept
+{
+	g_fillPatternKernel.load( std::memory_order_relaxed )( dst, count, pattern, patternSize );
+}
+
+} // namespace impl
+
+
+//======================================================================================================================
+// copying
+
 void copyBytes_large( const uint8_t * RESTRICT_PTR src, uint8_t * RESTRICT_PTR dst, size_t count ) noexcept
 {
 	std::memcpy( dst, src, count );
@@ -32,4 +130,531 @@ void copyBytes_large_overlapping( const uint8_t * src, uint8_t * dst, size_t cou
 	std::memmove( dst, src, count );
 }
 
+
+//======================================================================================================================
+// streaming (non-temporal) access
+
+static std::atomic< size_t > g_streamingThreshold( c_defaultStreamingThreshold );
+
+size_t streamingThreshold() noexcept
+{
+	return g_streamingThreshold.load( std::memory_order_relaxed );
+}
+
+void setStreamingThreshold( size_t minSize ) noexcept
+{
+	g_streamingThreshold.store( minSize, std::memory_order_relaxed );
+}
+
+// The non-temporal stores require an aligned destination, so the head up to the first aligned address is written
+// normally, and so is the tail that doesn't fill a whole vector. The source may stay unaligned.
+// The non-temporal stores are weakly ordered, so at the end they are made globally visible before any following store,
+// so that other threads synchronized with this one see the data.
+
+#if defined(CPPUTILS_X86)
+
+TARGET_ISA("sse2")
+static void zeroBytes_streaming_sse2( uint8_t * dst, size_t count ) noexcept
+{
+	constexpr size_t vectorSize = sizeof( __m128i );
+	const size_t headSize = std::min( paddingTo( size_t( reinterpret_cast< uintptr_t >( dst ) ), vectorSize ), count );
+	std::memset( dst, 0, headSize );
+	uint8_t * pos = dst + headSize;
+	uint8_t * const end = dst + count;
+
+	const __m128i zero = _mm_setzero_si128();
+	for (; size_t( end - pos ) >= vectorSize; pos += vectorSize)
+	{
+		_mm_stream_si128( reinterpret_cast< __m128i * >( pos ), zero );
+	}
+	_mm_sfence();
+
+	std::memset( pos, 0, size_t( end - pos ) );
+}
+
+TARGET_ISA("avx2")
+static void zeroBytes_streaming_avx2( uint8_t * dst, size_t count ) noexcept
+{
+	constexpr size_t vectorSize = sizeof( __m256i );
+	const size_t headSize = std::min( paddingTo( size_t( reinterpret_cast< uintptr_t >( dst ) ), vectorSize ), count );
+	std::memset( dst, 0, headSize );
+	uint8_t * pos = dst + headSize;
+	uint8_t * const end = dst + count;
+
+	const __m256i zero = _mm256_setzero_si256();
+	for (; size_t( end - pos ) >= vectorSize; pos += vectorSize)
+	{
+		_mm256_stream_si256( reinterpret_cast< __m256i * >( pos ), zero );
+	}
+	_mm_sfence();
+
+	std::memset( pos, 0, size_t( end - pos ) );
+}
+
+TARGET_ISA("sse2")
+static void copyBytes_streaming_sse2( const uint8_t * RESTRICT_PTR src, uint8_t * RESTRICT_PTR dst, size_t count ) noexcept
+{
+	constexpr size_t vectorSize = sizeof( __m128i );
+	const size_t headSize = std::min( paddingTo( size_t( reinterpret_cast< uintptr_t >( dst ) ), vectorSize ), count );
+	std::memcpy( dst, src, headSize );
+	const uint8_t * srcPos = src + headSize;
+	uint8_t * dstPos = dst + headSize;
+	uint8_t * const dstEnd = dst + count;
+
+	for (; size_t( dstEnd - dstPos ) >= 4 * vectorSize; srcPos += 4 * vectorSize, dstPos += 4 * vectorSize)
+	{
+		// all loads first, so that they can be in flight at the same time
+		const __m128i v0 = _mm_loadu_si128( reinterpret_cast< const __m128i * >( srcPos ) );
+		const __m128i v1 = _mm_loadu_si128( reinterpret_cast< const __m128i * >( srcPos + vectorSize ) );
+		const __m128i v2 = _mm_loadu_si128( reinterpret_cast< const __m128i * >( srcPos + 2 * vectorSize ) );
+		const __m128i v3 = _mm_loadu_si128( reinterpret_cast< const __m128i * >( srcPos + 3 * vectorSize ) );
+		_mm_stream_si128( reinterpret_cast< __m128i * >( dstPos ), v0 );
+		_mm_stream_si128( reinterpret_cast< __m128i * >( dstPos + vectorSize ), v1 );
+		_mm_stream_si128( reinterpret_cast< __m128i * >( dstPos + 2 * vectorSize ), v2 );
+		_mm_stream_si128( reinterpret_cast< __m128i * >( dstPos + 3 * vectorSize ), v3 );
+	}
+	for (; size_t( dstEnd - dstPos ) >= vectorSize; srcPos += vectorSize, dstPos += vectorSize)
+	{
+		_mm_stream_si128( reinterpret_cast< __m128i * >( dstPos ), _mm_loadu_si128( reinterpret_cast< const __m128i * >( srcPos ) ) );
+	}
+	_mm_sfence();
+
+	std::memcpy( dstPos, srcPos, size_t( dstEnd - dstPos ) );
+}
+
+TARGET_ISA("avx2")
+static void copyBytes_streaming_avx2( const uint8_t * RESTRICT_PTR src, uint8_t * RESTRICT_PTR dst, size_t count ) noexcept
+{
+	constexpr size_t vectorSize = sizeof( __m256i );
+	const size_t headSize = std::min( paddingTo( size_t( reinterpret_cast< uintptr_t >( dst ) ), vectorSize ), count );
+	std::memcpy( dst, src, headSize );
+	const uint8_t * srcPos = src + headSize;
+	uint8_t * dstPos = dst + headSize;
+	uint8_t * const dstEnd = dst + count;
+
+	for (; size_t( dstEnd - dstPos ) >= 4 * vectorSize; srcPos += 4 * vectorSize, dstPos += 4 * vectorSize)
+	{
+		// all loads first, so that they can be in flight at the same time
+		const __m256i v0 = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( srcPos ) );
+		const __m256i v1 = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( srcPos + vectorSize ) );
+		const __m256i v2 = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( srcPos + 2 * vectorSize ) );
+		const __m256i v3 = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( srcPos + 3 * vectorSize ) );
+		_mm256_stream_si256( reinterpret_cast< __m256i * >( dstPos ), v0 );
+		_mm256_stream_si256( reinterpret_cast< __m256i * >( dstPos + vectorSize ), v1 );
+		_mm256_stream_si256( reinterpret_cast< __m256i * >( dstPos + 2 * vectorSize ), v2 );
+		_mm256_stream_si256( reinterpret_cast< __m256i * >( dstPos + 3 * vectorSize ), v3 );
+	}
+	for (; size_t( dstEnd - dstPos ) >= vectorSize; srcPos += vectorSize, dstPos += vectorSize)
+	{
+		_mm256_stream_si256( reinterpret_cast< __m256i * >( dstPos ), _mm256_loadu_si256( reinterpret_cast< const __m256i * >( srcPos ) ) );
+	}
+	_mm_sfence();
+
+	std::memcpy( dstPos, srcPos, size_t( dstEnd - dstPos ) );
+}
+
+#endif // CPPUTILS_X86
+
+static std::atomic< decltype( &zeroBytes_large ) > g_zeroBytesStreamingKernel( zeroBytes_large );
+
+void zeroBytes_streaming( uint8_t * dst, size_t count ) noexcept
+{
+	if (count >= streamingThreshold())
+		g_zeroBytesStreamingKernel.load( std::memory_order_relaxed )( dst, count );
+	else
+		zeroBytes_large( dst, count );
+}
+
+static std::atomic< decltype( &copyBytes_large ) > g_copyBytesStreamingKernel( copyBytes_large );
+
+void copyBytes_streaming( const uint8_t * RESTRICT_PTR src, uint8_t * RESTRICT_PTR dst, size_t count ) noexcept
+{
+	if (count >= streamingThreshold())
+		g_copyBytesStreamingKernel.load( std::memory_order_relaxed )( src, dst, count );
+	else
+		copyBytes_large( src, dst, count );
+}
+
+
+//======================================================================================================================
+// parallel copying
+
+// Chunks sharing a page would make the threads fight for the same TLB entries and, on the first touch of a fresh
+// allocation, for the same page fault.
+static constexpr size_t c_pageSize = 4096;
+
+void copyBytes_parallel( const uint8_t * RESTRICT_PTR src, uint8_t * RESTRICT_PTR dst, size_t count, ThreadPool & pool )
+{
+	const size_t numThreads = pool.numThreads();
+	if (count < c_minParallelCopySize || numThreads == 1)
+	{
+		copyBytes_streaming( src, dst, count );
+		return;
+	}
+
+	// chunk boundaries are at page boundaries of the destination, only the first and the last chunk can be partial
+	const uintptr_t dstBegin = reinterpret_cast< uintptr_t >( dst );
+	const uintptr_t dstEnd = dstBegin + count;
+	const uintptr_t pagesBegin = dstBegin - dstBegin % c_pageSize;
+	const size_t chunkSize = div_ceil( div_ceil( dstEnd - pagesBegin, numThreads ), c_pageSize ) * c_pageSize;
+	const size_t numChunks = div_ceil( dstEnd - pagesBegin, chunkSize );
+
+	pool.runParallel( numChunks, [&]( size_t chunkIdx )
+	{
+		const uintptr_t chunkBegin = std::max( pagesBegin + chunkIdx * chunkSize, dstBegin );
+		const uintptr_t chunkEnd = std::min( pagesBegin + (chunkIdx + 1) * chunkSize, dstEnd );
+		const size_t offset = chunkBegin - dstBegin;
+		copyBytes_streaming( src + offset, dst + offset, chunkEnd - chunkBegin );
+	});
+}
+
+
+//======================================================================================================================
+// comparison
+
+template< typename Type >
+static inline Type loadUnaligned( const uint8_t * pos ) noexcept
+{
+	Type value;
+	std::memcpy( &value, pos, sizeof( Type ) );
+	return value;
+}
+
+#if defined(CPPUTILS_X86)
+
+// returns a mask with bit i set when the bytes i differ
+TARGET_ISA("sse2")
+static inline uint32_t differenceMask16( const uint8_t * a1, const uint8_t * a2 ) noexcept
+{
+	const __m128i v1 = _mm_loadu_si128( reinterpret_cast< const __m128i * >( a1 ) );
+	const __m128i v2 = _mm_loadu_si128( reinterpret_cast< const __m128i * >( a2 ) );
+	return ~uint32_t( _mm_movemask_epi8( _mm_cmpeq_epi8( v1, v2 ) ) ) & 0xFFFF;
+}
+
+// returns a mask with bit i set when the bytes i differ
+TARGET_ISA("avx2")
+static inline uint32_t differenceMask32( const uint8_t * a1, const uint8_t * a2 ) noexcept
+{
+	const __m256i v1 = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( a1 ) );
+	const __m256i v2 = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( a2 ) );
+	return ~uint32_t( _mm256_movemask_epi8( _mm256_cmpeq_epi8( v1, v2 ) ) );
+}
+
+#endif // CPPUTILS_X86
+
+// The rest that doesn't fill a whole block is compared by one more block ending at the end of the ranges.
+// It overlaps the already compared part, but that part is equal, so it doesn't affect the result.
+// The vectorized variants leave the ranges shorter than their vector to the narrower variants.
+
+static int compareBytes_scalar( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept
+{
+	size_t offset = 0;
+
+	if (count >= 8)
+	{
+		for (; offset < count; offset += 8)
+		{
+			offset = std::min( offset, count - 8 );
+			const uint64_t w1 = loadUnaligned< uint64_t >( a1 + offset );
+			const uint64_t w2 = loadUnaligned< uint64_t >( a2 + offset );
+			if (w1 != w2)
+			{
+				const size_t idx = offset + impl::firstDifferentByte( w1, w2 );
+				return int( a1[ idx ] ) - int( a2[ idx ] );
+			}
+		}
+		return 0;
+	}
+
+	for (; offset < count; ++offset)
+	{
+		if (a1[ offset ] != a2[ offset ])
+			return int( a1[ offset ] ) - int( a2[ offset ] );
+	}
+	return 0;
+}
+
+#if defined(CPPUTILS_X86)
+
+TARGET_ISA("sse2")
+static int compareBytes_sse2( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept
+{
+	if (count < 16)
+		return compareBytes_scalar( a1, a2, count );
+
+	for (size_t offset = 0; offset < count; offset += 16)
+	{
+		offset = std::min( offset, count - 16 );
+		if (const uint32_t diffMask = differenceMask16( a1 + offset, a2 + offset ))
+		{
+			const size_t idx = offset + countTrailingZeros( diffMask );
+			return int( a1[ idx ] ) - int( a2[ idx ] );
+		}
+	}
+	return 0;
+}
+
+TARGET_ISA("avx2")
+static int compareBytes_avx2( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept
+{
+	if (count < 32)
+		return compareBytes_sse2( a1, a2, count );
+
+	for (size_t offset = 0; offset < count; offset += 32)
+	{
+		offset = std::min( offset, count - 32 );
+		if (const uint32_t diffMask = differenceMask32( a1 + offset, a2 + offset ))
+		{
+			const size_t idx = offset + countTrailingZeros( diffMask );
+			return int( a1[ idx ] ) - int( a2[ idx ] );
+		}
+	}
+	return 0;
+}
+
+#endif // CPPUTILS_X86
+
+static std::atomic< decltype( &compareBytes_scalar ) > g_compareBytesKernel( compareBytes_scalar );
+
+int compareBytes( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept
+{
+	return g_compareBytesKernel.load( std::memory_order_relaxed )( a1, a2, count );
+}
+
+// short ranges are compared by 2 overlapping words without any loop
+static inline bool equalBytes_short( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept
+{
+	if (count < 4)
+	{
+		for (size_t i = 0; i < count; ++i)
+			if (a1[ i ] != a2[ i ])
+				return false;
+		return true;
+	}
+	if (count <= 8)
+	{
+		return loadUnaligned< uint32_t >( a1 ) == loadUnaligned< uint32_t >( a2 )
+		    && loadUnaligned< uint32_t >( a1 + count - 4 ) == loadUnaligned< uint32_t >( a2 + count - 4 );
+	}
+	return loadUnaligned< uint64_t >( a1 ) == loadUnaligned< uint64_t >( a2 )
+	    && loadUnaligned< uint64_t >( a1 + count - 8 ) == loadUnaligned< uint64_t >( a2 + count - 8 );
+}
+
+static bool equalBytes_scalar( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept
+{
+	if (count <= 16)
+		return equalBytes_short( a1, a2, count );
+
+	for (size_t offset = 0; offset < count; offset += 8)
+	{
+		offset = std::min( offset, count - 8 );
+		if (loadUnaligned< uint64_t >( a1 + offset ) != loadUnaligned< uint64_t >( a2 + offset ))
+			return false;
+	}
+	return true;
+}
+
+#if defined(CPPUTILS_X86)
+
+TARGET_ISA("sse2")
+static bool equalBytes_sse2( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept
+{
+	if (count <= 16)
+		return equalBytes_short( a1, a2, count );
+
+	for (size_t offset = 0; offset < count; offset += 16)
+	{
+		offset = std::min( offset, count - 16 );
+		if (differenceMask16( a1 + offset, a2 + offset ) != 0)
+			return false;
+	}
+	return true;
+}
+
+TARGET_ISA("avx2")
+static bool equalBytes_avx2( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept
+{
+	if (count < 32)
+		return equalBytes_sse2( a1, a2, count );
+
+	for (size_t offset = 0; offset < count; offset += 32)
+	{
+		offset = std::min( offset, count - 32 );
+		if (differenceMask32( a1 + offset, a2 + offset ) != 0)
+			return false;
+	}
+	return true;
+}
+
+#endif // CPPUTILS_X86
+
+static std::atomic< decltype( &equalBytes_scalar ) > g_equalBytesKernel( equalBytes_scalar );
+
+bool equalBytes( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept
+{
+	return g_equalBytesKernel.load( std::memory_order_relaxed )( a1, a2, count );
+}
+
+
+//======================================================================================================================
+// searching
+
+// The vectorized variants leave the rest that doesn't fill a whole vector to the narrower variants.
+
+static const uint8_t * findByte_scalar( const uint8_t * begin, const uint8_t * end, uint8_t value ) noexcept
+{
+	if (begin == end)
+		return end;  // memchr doesn't accept null pointers, not even with zero size
+	const void * found = std::memchr( begin, value, size_t( end - begin ) );
+	return found ? static_cast< const uint8_t * >( found ) : end;
+}
+
+#if defined(CPPUTILS_X86)
+
+TARGET_ISA("sse2")
+static const uint8_t * findByte_sse2( const uint8_t * begin, const uint8_t * end, uint8_t value ) noexcept
+{
+	const uint8_t * pos = begin;
+	const __m128i searched = _mm_set1_epi8( char( value ) );
+	for (; end - pos >= 16; pos += 16)
+	{
+		const __m128i data = _mm_loadu_si128( reinterpret_cast< const __m128i * >( pos ) );
+		const uint32_t matchMask = uint32_t( _mm_movemask_epi8( _mm_cmpeq_epi8( data, searched ) ) );
+		if (matchMask != 0)
+			return pos + countTrailingZeros( matchMask );
+	}
+	return findByte_scalar( pos, end, value );
+}
+
+TARGET_ISA("avx2")
+static const uint8_t * findByte_avx2( const uint8_t * begin, const uint8_t * end, uint8_t value ) noexcept
+{
+	const uint8_t * pos = begin;
+	const __m256i searched = _mm256_set1_epi8( char( value ) );
+	for (; end - pos >= 32; pos += 32)
+	{
+		const __m256i data = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( pos ) );
+		const uint32_t matchMask = uint32_t( _mm256_movemask_epi8( _mm256_cmpeq_epi8( data, searched ) ) );
+		if (matchMask != 0)
+			return pos + countTrailingZeros( matchMask );
+	}
+	return findByte_sse2( pos, end, value );
+}
+
+#endif // CPPUTILS_X86
+
+static std::atomic< decltype( &findByte_scalar ) > g_findByteKernel( findByte_scalar );
+
+const uint8_t * findByte( const uint8_t * begin, const uint8_t * end, uint8_t value ) noexcept
+{
+	return g_findByteKernel.load( std::memory_order_relaxed )( begin, end, value );
+}
+
+// every searched value costs one comparison per block, so with many values the lookup table is faster
+static constexpr size_t c_maxVectorizedValues = 8;
+
+static const uint8_t * findAnyOf_scalar( const uint8_t * begin, const uint8_t * end, const uint8_t * values, size_t numValues ) noexcept
+{
+	bool isSearched [256] = {};
+	for (size_t i = 0; i < numValues; ++i)
+		isSearched[ values[ i ] ] = true;
+	for (const uint8_t * pos = begin; pos < end; ++pos)
+		if (isSearched[ *pos ])
+			return pos;
+	return end;
+}
+
+#if defined(CPPUTILS_X86)
+
+TARGET_ISA("sse2")
+static const uint8_t * findAnyOf_sse2( const uint8_t * begin, const uint8_t * end, const uint8_t * values, size_t numValues ) noexcept
+{
+	const uint8_t * pos = begin;
+	if (numValues <= c_maxVectorizedValues)
+	{
+		__m128i searched [c_maxVectorizedValues];
+		for (size_t i = 0; i < numValues; ++i)
+			searched[ i ] = _mm_set1_epi8( char( values[ i ] ) );
+		for (; end - pos >= 16; pos += 16)
+		{
+			const __m128i data = _mm_loadu_si128( reinterpret_cast< const __m128i * >( pos ) );
+			__m128i matches = _mm_setzero_si128();
+			for (size_t i = 0; i < numValues; ++i)
+				matches = _mm_or_si128( matches, _mm_cmpeq_epi8( data, searched[ i ] ) );
+			const uint32_t matchMask = uint32_t( _mm_movemask_epi8( matches ) );
+			if (matchMask != 0)
+				return pos + countTrailingZeros( matchMask );
+		}
+	}
+	return findAnyOf_scalar( pos, end, values, numValues );
+}
+
+TARGET_ISA("avx2")
+static const uint8_t * findAnyOf_avx2( const uint8_t * begin, const uint8_t * end, const uint8_t * values, size_t numValues ) noexcept
+{
+	const uint8_t * pos = begin;
+	if (numValues <= c_maxVectorizedValues)
+	{
+		__m256i searched [c_maxVectorizedValues];
+		for (size_t i = 0; i < numValues; ++i)
+			searched[ i ] = _mm256_set1_epi8( char( values[ i ] ) );
+		for (; end - pos >= 32; pos += 32)
+		{
+			const __m256i data = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( pos ) );
+			__m256i matches = _mm256_setzero_si256();
+			for (size_t i = 0; i < numValues; ++i)
+				matches = _mm256_or_si256( matches, _mm256_cmpeq_epi8( data, searched[ i ] ) );
+			const uint32_t matchMask = uint32_t( _mm256_movemask_epi8( matches ) );
+			if (matchMask != 0)
+				return pos + countTrailingZeros( matchMask );
+		}
+	}
+	return findAnyOf_sse2( pos, end, values, numValues );
+}
+
+#endif // CPPUTILS_X86
+
+static std::atomic< decltype( &findAnyOf_scalar ) > g_findAnyOfKernel( findAnyOf_scalar );
+
+const uint8_t * findAnyOf( const uint8_t * begin, const uint8_t * end, const uint8_t * values, size_t numValues ) noexcept
+{
+	if (numValues == 1)
+		return findByte( begin, end, values[0] );
+
+	return g_findAnyOfKernel.load( std::memory_order_relaxed )( begin, end, values, numValues );
+}
+
+
+//======================================================================================================================
+// kernel binding
+
+static void bindKernels( SimdLevel level ) noexcept
+{
+	static decltype( &fillPattern_scalar ) const fillPatternKernels [] =
+		SIMD_KERNEL_TABLE( fillPattern_scalar, fillPattern_sse2, fillPattern_sse2, fillPattern_avx2 );
+	static decltype( &zeroBytes_large ) const zeroBytesStreamingKernels [] =
+		SIMD_KERNEL_TABLE( zeroBytes_large, zeroBytes_streaming_sse2, zeroBytes_streaming_sse2, zeroBytes_streaming_avx2 );
+	static decltype( &copyBytes_large ) const copyBytesStreamingKernels [] =
+		SIMD_KERNEL_TABLE( copyBytes_large, copyBytes_streaming_sse2, copyBytes_streaming_sse2, copyBytes_streaming_avx2 );
+	static decltype( &compareBytes_scalar ) const compareBytesKernels [] =
+		SIMD_KERNEL_TABLE( compareBytes_scalar, compareBytes_sse2, compareBytes_sse2, compareBytes_avx2 );
+	static decltype( &equalBytes_scalar ) const equalBytesKernels [] =
+		SIMD_KERNEL_TABLE( equalBytes_scalar, equalBytes_sse2, equalBytes_sse2, equalBytes_avx2 );
+	static decltype( &findByte_scalar ) const findByteKernels [] =
+		SIMD_KERNEL_TABLE( findByte_scalar, findByte_sse2, findByte_sse2, findByte_avx2 );
+	static decltype( &findAnyOf_scalar ) const findAnyOfKernels [] =
+		SIMD_KERNEL_TABLE( findAnyOf_scalar, findAnyOf_sse2, findAnyOf_sse2, findAnyOf_avx2 );
+
+	impl::bindKernel( g_fillPatternKernel, fillPatternKernels, level );
+	impl::bindKernel( g_zeroBytesStreamingKernel, zeroBytesStreamingKernels, level );
+	impl::bindKernel( g_copyBytesStreamingKernel, copyBytesStreamingKernels, level );
+	impl::bindKernel( g_compareBytesKernel, compareBytesKernels, level );
+	impl::bindKernel( g_equalBytesKernel, equalBytesKernels, level );
+	impl::bindKernel( g_findByteKernel, findByteKernels, level );
+	impl::bindKernel( g_findAnyOfKernel, findAnyOfKernels, level );
+}
+
+static impl::KernelBinder g_kernelBinder( bindKernels );
+
+
 } // namespace own
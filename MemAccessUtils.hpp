@@ -12,8 +12,10 @@
 #include "Essential.hpp"
 
 //#include "TypeTraits.hpp"  // REQUIRES
+#include "MathUtils.hpp"  // countLeadingZeros, countTrailingZeros
 
 #include <algorithm>
+#include <type_traits>
 
 
 // This should work for most of the compilers, including MSVC. Others will have to find their alternative.
@@ -74,6 +76,62 @@ template<> inline void zeroBytes_aligned< 16 >( uint8_t * dst ) noexcept
 	reinterpret_cast< uint64_t * >( dst )[1] = 0;
 }
 
+/// Sets all bytes in a memory range starting at \p dst and ending at \p dst + \p count to \p value.
+/** General purpose variant suitable for most use-cases. */
+inline void fillBytes( uint8_t * dst, size_t count, uint8_t value ) noexcept
+{
+	std::fill( dst, dst + count, value );
+}
+
+/// Sets all bytes in a memory range starting at \p dst and ending at \p dst + \p count to \p value.
+/** Variant optimized for large chunks for the cost of a function call. */
+void fillBytes_large( uint8_t * dst, size_t count, uint8_t value ) noexcept;
+
+/// Sets all bytes in a memory range starting at \p dst and ending at \p dst + \p count to \p value.
+/** Variant optimized for small, fixed size memory ranges that are aligned to a multiple of their size. */
+template< size_t count > inline void fillBytes_aligned( uint8_t * dst, uint8_t value ) noexcept
+{
+	std::fill( dst, dst + count, value );  // fallback for unknown size
+}
+// The value is replicated into all bytes of a word by multiplication and the word is stored at once.
+template<> inline void fillBytes_aligned< 2 >( uint8_t * dst, uint8_t value ) noexcept
+{
+	*reinterpret_cast< uint16_t * >( dst ) = uint16_t( value * 0x0101u );
+}
+template<> inline void fillBytes_aligned< 4 >( uint8_t * dst, uint8_t value ) noexcept
+{
+	*reinterpret_cast< uint32_t * >( dst ) = value * 0x01010101u;
+}
+template<> inline void fillBytes_aligned< 8 >( uint8_t * dst, uint8_t value ) noexcept
+{
+	*reinterpret_cast< uint64_t * >( dst ) = value * 0x0101010101010101ull;
+}
+template<> inline void fillBytes_aligned< 16 >( uint8_t * dst, uint8_t value ) noexcept
+{
+	reinterpret_cast< uint64_t * >( dst )[0] = value * 0x0101010101010101ull;
+	reinterpret_cast< uint64_t * >( dst )[1] = value * 0x0101010101010101ull;
+}
+
+namespace impl {
+
+void fillPattern( uint8_t * dst, size_t count, const uint8_t * pattern, size_t patternSize ) noexcept;
+
+} // namespace impl
+
+/// Fills a memory range starting at \p dst and ending at \p dst + \p count by repeating the bytes of \p pattern.
+/** The pattern must be 2, 4, 8 or 16 bytes large. It's repeated in its in-memory representation, starting from \p dst,
+  * so filling an array of Patterns sets each element to \p pattern, regardless of the alignment of the array.
+  * If \p count is not a multiple of the pattern size, the last repetition is cut short.
+  * Example: fillPattern( reinterpret_cast< uint8_t * >( table ), sizeof( table ), uint32_t( 0xDEADBEEF ) ); */
+template< typename Pattern >
+void fillPattern( uint8_t * dst, size_t count, const Pattern & pattern ) noexcept
+{
+	static_assert( std::is_trivially_copyable< Pattern >::value, "the pattern must be copyable as bytes" );
+	static_assert( sizeof( Pattern ) == 2 || sizeof( Pattern ) == 4 || sizeof( Pattern ) == 8 || sizeof( Pattern ) == 16,
+	               "the pattern size must be 2, 4, 8 or 16 bytes" );
+	impl::fillPattern( dst, count, reinterpret_cast< const uint8_t * >( &pattern ), sizeof( Pattern ) );
+}
+
 
 //======================================================================================================================
 // copying
@@ -103,6 +161,18 @@ void copyBytes_large( const uint8_t * RESTRICT_PTR src, uint8_t * RESTRICT_PTR d
 /** Variant optimized for large chunks for the cost of a function call. Memory ranges can overlap. */
 void copyBytes_large_overlapping( const uint8_t * src, uint8_t * dst, size_t count ) noexcept;
 
+class ThreadPool;
+
+/// Minimum number of bytes for which copyBytes_parallel() actually splits the work among the threads.
+constexpr size_t c_minParallelCopySize = 4 * 1024 * 1024;
+
+/// Copies \p count bytes from memory range starting at \p src to range starting at \p dst, using all the threads of the pool.
+/** Variant for huge memory ranges, whose copying is limited by the memory bandwidth of a single core.
+  * The destination is split into page-aligned chunks, one for each thread, and each chunk is copied by
+  * copyBytes_streaming(). Below c_minParallelCopySize, it's the same as copyBytes_streaming().
+  * Memory ranges must not overlap. */
+void copyBytes_parallel( const uint8_t * RESTRICT_PTR src, uint8_t * RESTRICT_PTR dst, size_t count, ThreadPool & pool );
+
 /// Copies \p count bytes from memory range starting at \p src to range starting at \p dst.
 /** Variant optimized for small, fixed size memory ranges that are aligned to a multiple of their size.
   * The ranges must not overlap. */
@@ -131,12 +201,138 @@ template<> inline void copyBytes_aligned< 16 >( const uint8_t * RESTRICT_PTR src
 }
 
 
+//======================================================================================================================
+// streaming (non-temporal) access
+
+// Variants for huge memory ranges that are not going to be read again soon, for example when moving whole frames
+// between buffers. Above the streaming threshold, they write with non-temporal stores that bypass the CPU caches,
+// so that they don't evict the data other threads are working with. Below the threshold, or when the CPU doesn't
+// support SSE2, they are the same as the _large variants.
+
+/// Default minimum size of a memory range to be written with non-temporal stores.
+constexpr size_t c_defaultStreamingThreshold = 1024 * 1024;
+
+/// Returns the minimum size of a memory range to be written with non-temporal stores.
+size_t streamingThreshold() noexcept;
+
+/// Sets the minimum size of a memory range to be written with non-temporal stores.
+/** The best value depends on the size of the last level cache and on how much of it the other threads need.
+  * It is shared by all the threads. */
+void setStreamingThreshold( size_t minSize ) noexcept;
+
+/// Zeroes all bytes in a memory range starting at \p dst and ending at \p dst + \p count, bypassing the CPU caches.
+void zeroBytes_streaming( uint8_t * dst, size_t count ) noexcept;
+
+/// Copies \p count bytes from memory range starting at \p src to range starting at \p dst, bypassing the CPU caches.
+/** Memory ranges must not overlap. */
+void copyBytes_streaming( const uint8_t * RESTRICT_PTR src, uint8_t * RESTRICT_PTR dst, size_t count ) noexcept;
+
+
 //======================================================================================================================
 // comparison
 
-inline int compareBytes( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept
+namespace impl {
+
+/// Returns the index (in memory order) of the first byte in which the two words loaded from memory differ.
+/** The words must not be equal. */
+template< typename UInt >
+inline size_t firstDifferentByte( UInt w1, UInt w2 ) noexcept
+{
+ #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	return countLeadingZeros( uint64_t( w1 ^ w2 ) << (64 - 8 * sizeof( UInt )) ) / 8;
+ #else
+	return countTrailingZeros( uint64_t( w1 ^ w2 ) ) / 8;
+ #endif
+}
+
+} // namespace impl
+
+/// Compares \p count bytes of memory ranges starting at \p a1 and \p a2 lexicographically as unsigned bytes.
+/** Returns a negative number if a1 is lower, 0 if they are equal and a positive number if a1 is greater,
+  * the same as memcmp. Uses SSE2 or AVX2 when the CPU supports them. */
+int compareBytes( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept;
+
+/// Returns whether \p count bytes of memory ranges starting at \p a1 and \p a2 are equal.
+/** Faster than compareBytes() when the order is not needed, especially for short ranges.
+  * Uses SSE2 or AVX2 when the CPU supports them. */
+bool equalBytes( const uint8_t * a1, const uint8_t * a2, size_t count ) noexcept;
+
+/// Compares \p count bytes of memory ranges starting at \p a1 and \p a2 lexicographically as unsigned bytes.
+/** Variant optimized for small, fixed size memory ranges that are aligned to a multiple of their size.
+  * The result has the same meaning as in compareBytes(). */
+template< size_t count > inline int compareBytes_aligned( const uint8_t * a1, const uint8_t * a2 ) noexcept
+{
+	return compareBytes( a1, a2, count );  // fallback for unknown size
+}
+// The words are compared at once, and only if they differ, the first different byte is located from their XOR.
+template<> inline int compareBytes_aligned< 2 >( const uint8_t * a1, const uint8_t * a2 ) noexcept
+{
+	const uint16_t w1 = *reinterpret_cast< const uint16_t * >( a1 );
+	const uint16_t w2 = *reinterpret_cast< const uint16_t * >( a2 );
+	if (w1 == w2)
+		return 0;
+	const size_t idx = impl::firstDifferentByte( w1, w2 );
+	return int( a1[ idx ] ) - int( a2[ idx ] );
+}
+template<> inline int compareBytes_aligned< 4 >( const uint8_t * a1, const uint8_t * a2 ) noexcept
+{
+	const uint32_t w1 = *reinterpret_cast< const uint32_t * >( a1 );
+	const uint32_t w2 = *reinterpret_cast< const uint32_t * >( a2 );
+	if (w1 == w2)
+		return 0;
+	const size_t idx = impl::firstDifferentByte( w1, w2 );
+	return int( a1[ idx ] ) - int( a2[ idx ] );
+}
+template<> inline int compareBytes_aligned< 8 >( const uint8_t * a1, const uint8_t * a2 ) noexcept
+{
+	const uint64_t w1 = *reinterpret_cast< const uint64_t * >( a1 );
+	const uint64_t w2 = *reinterpret_cast< const uint64_t * >( a2 );
+	if (w1 == w2)
+		return 0;
+	const size_t idx = impl::firstDifferentByte( w1, w2 );
+	return int( a1[ idx ] ) - int( a2[ idx ] );
+}
+template<> inline int compareBytes_aligned< 16 >( const uint8_t * a1, const uint8_t * a2 ) noexcept
+{
+	const int result = compareBytes_aligned< 8 >( a1, a2 );
+	return result != 0 ? result : compareBytes_aligned< 8 >( a1 + 8, a2 + 8 );
+}
+
+
+//======================================================================================================================
+// searching
+
+/// Returns the position of the first byte equal to \p value in a memory range starting at \p begin and ending at \p end,
+/// or \p end if there is no such byte.
+/** Uses SSE2 or AVX2 when the CPU supports them, it never reads past the end of the range. */
+const uint8_t * findByte( const uint8_t * begin, const uint8_t * end, uint8_t value ) noexcept;
+
+/// Returns the position of the first byte equal to any of the \p numValues bytes at \p values in a memory range
+/// starting at \p begin and ending at \p end, or \p end if there is no such byte.
+/** Uses SSE2 or AVX2 when the CPU supports them and there are at most 8 searched values,
+  * it never reads past the end of the range. */
+const uint8_t * findAnyOf( const uint8_t * begin, const uint8_t * end, const uint8_t * values, size_t numValues ) noexcept;
+
+
+//======================================================================================================================
+// alignment
+
+/// Size of a CPU cache line on all the common architectures.
+/** Data written by different threads should be separated by this distance, to avoid false sharing. */
+constexpr size_t c_cacheLineSize = 64;
+
+/// Returns whether \p ptr points to an address that is a multiple of \p alignment.
+/** Alignment 0 means no requirement, any address satisfies it. */
+inline bool isAligned( const void * ptr, size_t alignment ) noexcept
+{
+	return alignment == 0 || reinterpret_cast< uintptr_t >( ptr ) % alignment == 0;
+}
+
+/// Returns how many bytes must be added to \p offset to make it a multiple of \p alignment.
+/** Alignment 0 means no requirement, so no padding is needed. */
+inline size_t paddingTo( size_t offset, size_t alignment ) noexcept
 {
-	return std::lexicographical_compare( a1, a1 + count, a2, a2 + count );
+	return alignment == 0 ? 0 : (alignment - offset % alignment) % alignment;
 }
 
 
@@ -0,0 +1,145 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: encoding and decoding of large arrays of structs split among multiple threads
+//======================================================================================================================
+
+#ifndef CPPUTILS_PARALLEL_SERIALIZATION_INCLUDED
+#define CPPUTILS_PARALLEL_SERIALIZATION_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "StructLayout.hpp"
+#include "BinaryStream.hpp"
+#include "ThreadPool.hpp"
+#include "MemAccessUtils.hpp"  // c_cacheLineSize
+#include "MathUtils.hpp"  // div_ceil
+#include "Span.hpp"
+#include "SafetyChecks.hpp"
+
+#include <algorithm>  // min, max
+
+
+// The records have fixed size, so the position of each of them in the buffer is known in advance. The array is split
+// into chunks and each chunk is encoded by a different thread through its own stream over a disjoint part of the buffer.
+
+
+namespace own {
+
+
+//======================================================================================================================
+// private implementation details
+
+namespace impl {
+
+/// Returns how many records should be processed by a single task.
+/** The chunks are big enough to amortize the synchronization, there are a few of them per thread to balance the load,
+  * and their size is a multiple of the cache line, so that 2 threads never write into the same cache line
+  * (provided that the buffer itself is aligned to the cache line). */
+inline size_t recordsPerChunk( size_t recordSize, size_t numRecords, size_t numThreads ) noexcept
+{
+	constexpr size_t minChunkSize = 64 * 1024;
+	constexpr size_t chunksPerThread = 4;
+
+	// the smallest number of records whose total size is a multiple of the cache line
+	size_t gcd = recordSize;
+	for (size_t rest = c_cacheLineSize; rest != 0; )
+	{
+		const size_t newRest = gcd % rest;
+		gcd = rest;
+		rest = newRest;
+	}
+	const size_t recordsPerLines = c_cacheLineSize / gcd;
+
+	const size_t recordsPerChunk = std::max( div_ceil( numRecords, numThreads * chunksPerThread ), div_ceil( minChunkSize, recordSize ) );
+	return div_ceil( recordsPerChunk, recordsPerLines ) * recordsPerLines;
+}
+
+/// Calls \p processChunk( firstRecordIdx, numRecords ) for every chunk of the records in parallel.
+template< typename Func >
+void forEachChunkParallel( size_t recordSize, size_t numRecords, ThreadPool & pool, const Func & processChunk )
+{
+	if (numRecords == 0)
+		return;
+	const size_t chunkSize = recordsPerChunk( recordSize, numRecords, pool.numThreads() );
+	pool.runParallel( div_ceil( numRecords, chunkSize ), [&]( size_t chunkIdx )
+	{
+		const size_t firstRecordIdx = chunkIdx * chunkSize;
+		processChunk( firstRecordIdx, std::min( chunkSize, numRecords - firstRecordIdx ) );
+	});
+}
+
+} // namespace impl
+
+
+//======================================================================================================================
+// buffer operations
+
+/// Encodes an array of structs according to a StructLayout into a buffer, using all the threads of the pool.
+/** The buffer must have space for at least records.size() * Layout::c_size bytes. */
+template< typename Layout >
+void encodeStructsParallel( span< const typename Layout::struct_type > records, byte_span buffer, ThreadPool & pool )
+{
+	SAFETY_CHECK( records.size() * Layout::c_size <= buffer.size(), "The buffer is too small for the encoded records" );
+	impl::forEachChunkParallel( Layout::c_size, records.size(), pool, [&]( size_t firstRecordIdx, size_t numRecords )
+	{
+		BinaryOutputStream chunkStream( make_span( buffer.data() + firstRecordIdx * Layout::c_size, numRecords * Layout::c_size ) );
+		for (size_t recordIdx = firstRecordIdx; recordIdx < firstRecordIdx + numRecords; ++recordIdx)
+		{
+			chunkStream.writeStruct< Layout >( records.data()[ recordIdx ] );
+		}
+	});
+}
+
+/// Decodes an array of structs according to a StructLayout from a buffer, using all the threads of the pool.
+/** The buffer must contain at least records.size() * Layout::c_size bytes. */
+template< typename Layout >
+void decodeStructsParallel( const_byte_span buffer, span< typename Layout::struct_type > records, ThreadPool & pool )
+{
+	SAFETY_CHECK( records.size() * Layout::c_size <= buffer.size(), "The buffer doesn't contain all the records" );
+	impl::forEachChunkParallel( Layout::c_size, records.size(), pool, [&]( size_t firstRecordIdx, size_t numRecords )
+	{
+		BinaryInputStream chunkStream( make_span( buffer.data() + firstRecordIdx * Layout::c_size, numRecords * Layout::c_size ) );
+		for (size_t recordIdx = firstRecordIdx; recordIdx < firstRecordIdx + numRecords; ++recordIdx)
+		{
+			chunkStream.readStruct< Layout >( records.data()[ recordIdx ] );
+		}
+	});
+}
+
+
+//======================================================================================================================
+// stream operations
+
+/// Encodes an array of structs according to a StructLayout into a stream, using all the threads of the pool.
+/** The space for all the records is reserved at once, so growing streams are enlarged only once. */
+template< typename Layout >
+void writeStructsParallel( BinaryOutputStream & stream, span< const typename Layout::struct_type > records, ThreadPool & pool )
+{
+	OutputRecordCursor cursor = stream.reserveRecord( records.size() * Layout::c_size );
+	encodeStructsParallel< Layout >( records, cursor.remainingBytes(), pool );
+}
+
+/// Decodes an array of structs according to a StructLayout from a stream, using all the threads of the pool.
+/** If the stream doesn't contain all the records, it fails and nothing is decoded. */
+template< typename Layout >
+bool readStructsParallel( BinaryInputStream & stream, span< typename Layout::struct_type > records, ThreadPool & pool )
+{
+	InputRecordCursor cursor = stream.reserveRecord( records.size() * Layout::c_size );
+	if (cursor)
+	{
+		decodeStructsParallel< Layout >( cursor.remainingBytes(), records, pool );
+	}
+	return !stream.failed();
+}
+
+
+//======================================================================================================================
+
+
+} // namespace own
+
+
+#endif // CPPUTILS_PARALLEL_SERIALIZATION_INCLUDED
@@ -0,0 +1,199 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: lazy random-access view over an encoded array of fixed-size records
+//======================================================================================================================
+
+#ifndef CPPUTILS_RECORD_ARRAY_VIEW_INCLUDED
+#define CPPUTILS_RECORD_ARRAY_VIEW_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "StructLayout.hpp"
+#include "Span.hpp"
+#include "TypeTraits.hpp"  // is_endian_serializable
+#include "SafetyChecks.hpp"
+
+#include <iterator>
+#include <type_traits>
+
+
+// Usage:
+//
+//   own::RecordArrayView< HeaderLayout > headers( fileData );
+//   uint32_t length = headers[ 1000 ].get< 2 >();  // decodes only the third field of the 1001st record
+//   auto found = own::find_if( headers, []( const auto & header ) { return header.get< 0 >() == 5; } );
+//   Header header = found->decode();
+
+
+namespace own {
+
+
+//======================================================================================================================
+/// Read-only view over an array of records encoded one after another according to a StructLayout.
+/** Nothing is decoded in advance, every access decodes only the requested record or even just the requested field.
+  * Thanks to the fixed size of the records, any record can be accessed in constant time.
+  * If the size of the data is not a multiple of the record size, the incomplete record at the end is ignored.
+  * WARNING: The view takes non-owning reference to the data.
+  * You are responsible for making sure the data exist at least as long as this object. */
+
+template< typename Layout >
+class RecordArrayView
+{
+
+	const uint8_t * _begin;
+	size_t _size;  ///< number of records
+
+ public:
+
+	using struct_type = typename Layout::struct_type;
+
+	//-- record --------------------------------------------------------------------------------------------------------
+
+	/// Single encoded record, its fields are decoded only when requested.
+	class Record
+	{
+		const uint8_t * _pos;
+
+	 public:
+
+		explicit Record( const uint8_t * pos ) noexcept : _pos( pos ) {}
+
+		/// Decodes the field of the given index (in the order of the layout definition).
+		template< size_t fieldIdx >
+		typename Layout::template field< fieldIdx >::member_type get() const noexcept
+		{
+			using Field = typename Layout::template field< fieldIdx >;
+			using Member = typename Field::member_type;
+			static_assert( is_endian_serializable< Member >::value, "array fields must be decoded into an output parameter" );
+			auto value = Member();
+			get< fieldIdx >( value );
+			return value;
+		}
+
+		/// Decodes the field of the given index (in the order of the layout definition) into an output parameter.
+		template< size_t fieldIdx >
+		void get( typename Layout::template field< fieldIdx >::member_type & value ) const noexcept
+		{
+			using Field = typename Layout::template field< fieldIdx >;
+			Field::template decodeValue< Layout::c_endianity >( _pos + Layout::template fieldOffset< fieldIdx >(), value );
+		}
+
+		/// Decodes the whole record.
+		void decode( struct_type & obj ) const noexcept
+		{
+			Layout::decode( _pos, obj );
+		}
+
+		/// Decodes the whole record.
+		struct_type decode() const noexcept
+		{
+			struct_type obj;
+			Layout::decode( _pos, obj );
+			return obj;
+		}
+
+		/// Returns the encoded bytes of the record.
+		const_byte_span bytes() const noexcept
+		{
+			return make_span( _pos, Layout::c_size );
+		}
+
+		// allows iterator-> to work with a temporary record
+		const Record * operator->() const noexcept
+		{
+			return this;
+		}
+	};
+
+	//-- iterator ------------------------------------------------------------------------------------------------------
+
+	/// Random-access iterator over the records. Dereferencing it returns the record by value.
+	class Iterator
+	{
+		const uint8_t * _pos;
+
+	 public:
+
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = Record;
+		using difference_type = ptrdiff_t;
+		using pointer = Record;  // operator-> returns a temporary record, which has its own operator->
+		using reference = Record;
+
+		Iterator() noexcept : _pos( nullptr ) {}
+		explicit Iterator( const uint8_t * pos ) noexcept : _pos( pos ) {}
+
+		Record operator*() const noexcept                      { return Record( _pos ); }
+		Record operator->() const noexcept                     { return Record( _pos ); }
+		Record operator[]( difference_type idx ) const noexcept  { return Record( _pos + idx * stride() ); }
+
+		Iterator & operator++() noexcept                       { _pos += stride(); return *this; }
+		Iterator operator++( int ) noexcept                    { Iterator old = *this; _pos += stride(); return old; }
+		Iterator & operator--() noexcept                       { _pos -= stride(); return *this; }
+		Iterator operator--( int ) noexcept                    { Iterator old = *this; _pos -= stride(); return old; }
+		Iterator & operator+=( difference_type n ) noexcept    { _pos += n * stride(); return *this; }
+		Iterator & operator-=( difference_type n ) noexcept    { _pos -= n * stride(); return *this; }
+
+		friend Iterator operator+( Iterator it, difference_type n ) noexcept  { return it += n; }
+		friend Iterator operator+( difference_type n, Iterator it ) noexcept  { return it += n; }
+		friend Iterator operator-( Iterator it, difference_type n ) noexcept  { return it -= n; }
+		friend difference_type operator-( const Iterator & a, const Iterator & b ) noexcept
+		{
+			return (a._pos - b._pos) / stride();
+		}
+
+		friend bool operator==( const Iterator & a, const Iterator & b ) noexcept  { return a._pos == b._pos; }
+		friend bool operator!=( const Iterator & a, const Iterator & b ) noexcept  { return a._pos != b._pos; }
+		friend bool operator<( const Iterator & a, const Iterator & b ) noexcept   { return a._pos < b._pos; }
+		friend bool operator>( const Iterator & a, const Iterator & b ) noexcept   { return a._pos > b._pos; }
+		friend bool operator<=( const Iterator & a, const Iterator & b ) noexcept  { return a._pos <= b._pos; }
+		friend bool operator>=( const Iterator & a, const Iterator & b ) noexcept  { return a._pos >= b._pos; }
+
+	 private:
+
+		static constexpr difference_type stride() noexcept
+		{
+			return difference_type( Layout::c_size );
+		}
+	};
+
+	// the view is read-only, so both are the same
+	using iterator = Iterator;
+	using const_iterator = Iterator;
+
+	//-- view ----------------------------------------------------------------------------------------------------------
+
+	RecordArrayView() noexcept : _begin( nullptr ), _size( 0 ) {}
+
+	explicit RecordArrayView( const_byte_span data ) noexcept
+		: _begin( data.data() ), _size( data.size() / Layout::c_size ) {}
+
+	size_t size() const noexcept    { return _size; }
+	bool empty() const noexcept     { return _size == 0; }
+
+	Iterator begin() const noexcept  { return Iterator( _begin ); }
+	Iterator end() const noexcept    { return Iterator( _begin + _size * Layout::c_size ); }
+
+	/// Returns the record of the given index without decoding it.
+	Record operator[]( size_t idx ) const
+	{
+		SAFETY_CHECK( idx < _size, "Record index out of bounds" );
+		return Record( _begin + idx * Layout::c_size );
+	}
+
+	/// Decodes the whole record of the given index.
+	struct_type decode( size_t idx ) const
+	{
+		return (*this)[ idx ].decode();
+	}
+
+};
+
+
+} // namespace own
+
+
+#endif // CPPUTILS_RECORD_ARRAY_VIEW_INCLUDED
@@ -0,0 +1,151 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: binary input stream that reads data from a source in chunks instead of from one complete buffer
+//======================================================================================================================
+
+#include "RefillingBinaryStream.hpp"
+
+#include <cerrno>
+
+#if defined(_WIN32)
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
+
+namespace own {
+
+
+//======================================================================================================================
+// data sources
+
+BinarySourceFunc fileDescriptorSource( int fd )
+{
+	return [ fd ]( byte_span buffer ) -> size_t
+	{
+		while (true)
+		{
+		 #if defined(_WIN32)
+			const auto readSize = ::_read( fd, buffer.data(), unsigned( buffer.size() ) );
+		 #else
+			const auto readSize = ::read( fd, buffer.data(), buffer.size() );
+		 #endif
+			if (readSize >= 0)
+				return size_t( readSize );
+			else if (errno != EINTR)
+				return 0;
+		}
+	};
+}
+
+BinarySourceFunc istreamSource( std::istream & is )
+{
+	return [ &is ]( byte_span buffer ) -> size_t
+	{
+		is.read( reinterpret_cast< char * >( buffer.data() ), std::streamsize( buffer.size() ) );
+		return size_t( is.gcount() );
+	};
+}
+
+
+//======================================================================================================================
+// RefillingBinaryInputStream
+
+constexpr size_t RefillingBinaryInputStream::c_defaultWindowSize;
+
+RefillingBinaryInputStream::RefillingBinaryInputStream( BinarySourceFunc source, size_t windowSize )
+	: BinaryInputStream( const_byte_span(), &refill )
+	, _source( std::move( source ) )
+	, _window( windowSize )
+	, _discardedSize( 0 )
+	, _sourceEnded( false )
+{
+	// the window starts empty, so that the first read triggers the refill
+	BinaryInputStream::reset( make_span( _window.data(), size_t(0) ) );
+}
+
+RefillingBinaryInputStream::RefillingBinaryInputStream( RefillingBinaryInputStream && other ) noexcept
+	: BinaryInputStream( std::move( other ) )
+	, _source( std::move( other._source ) )
+	, _window( std::move( other._window ) )  // moving a vector keeps the pointers into it valid
+	, _discardedSize( other._discardedSize )
+	, _sourceEnded( other._sourceEnded )
+{
+	other.BinaryInputStream::reset( const_byte_span() );
+	other._sourceEnded = true;
+}
+
+RefillingBinaryInputStream & RefillingBinaryInputStream::operator=( RefillingBinaryInputStream && other ) noexcept
+{
+	if (this != &other)
+	{
+		BinaryInputStream::operator=( std::move( other ) );
+		_source = std::move( other._source );
+		_window = std::move( other._window );
+		_discardedSize = other._discardedSize;
+		_sourceEnded = other._sourceEnded;
+
+		other.BinaryInputStream::reset( const_byte_span() );
+		other._sourceEnded = true;
+	}
+	return *this;
+}
+
+bool RefillingBinaryInputStream::skip( size_t numBytes ) noexcept
+{
+	while (!_failed && numBytes > remaining())
+	{
+		numBytes -= remaining();
+		_curPos = _endPos;
+		if (!refillIfEmpty())
+		{
+			_failed = true;
+		}
+	}
+	return BinaryInputStream::skip( numBytes );
+}
+
+void RefillingBinaryInputStream::refill( BinaryInputStream & base, size_t requiredSize ) noexcept
+{
+	auto & self = static_cast< RefillingBinaryInputStream & >( base );
+
+	if (self._sourceEnded || requiredSize > self._window.size())
+	{
+		return;  // the read is going to fail
+	}
+
+	// discard the consumed data and move the unread rest to the beginning of the window
+	uint8_t * const windowBeg = self._window.data();
+	const size_t consumedSize = size_t( self._curPos - windowBeg );
+	size_t filledSize = self.remaining();
+	if (consumedSize > 0)
+	{
+		copyBytes_overlapping( self._curPos, windowBeg, filledSize );
+		self._discardedSize += consumedSize;
+	}
+
+	// read as much as fits, so that the refills are as rare as possible
+	while (filledSize < requiredSize)
+	{
+		const size_t readSize = self._source( make_span( windowBeg + filledSize, self._window.size() - filledSize ) );
+		if (readSize == 0)
+		{
+			self._sourceEnded = true;
+			break;
+		}
+		filledSize += readSize;
+	}
+
+	self._begPos = windowBeg;
+	self._curPos = windowBeg;
+	self._endPos = windowBeg + filledSize;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace own
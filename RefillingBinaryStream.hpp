@@ -0,0 +1,140 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: binary input stream that reads data from a source in chunks instead of from one complete buffer
+//======================================================================================================================
+
+#ifndef CPPUTILS_REFILLING_BINARY_STREAM_INCLUDED
+#define CPPUTILS_REFILLING_BINARY_STREAM_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "BinaryStream.hpp"
+#include "Span.hpp"
+#include "MemAccessUtils.hpp"
+
+#include <vector>
+#include <functional>
+#include <istream>
+
+
+namespace own {
+
+
+//======================================================================================================================
+// data sources
+
+/// Function that reads up to buffer.size() bytes into the buffer and returns how many bytes it has read.
+/** Returning 0 means that the source has ended or that an error occured. The function must not throw. */
+using BinarySourceFunc = std::function< size_t ( byte_span buffer ) >;
+
+/// Creates a data source reading from a POSIX file descriptor (file, pipe, socket, ...).
+/** WARNING: The file descriptor is not owned by the source, you must keep it open while the source is used. */
+BinarySourceFunc fileDescriptorSource( int fd );
+
+/// Creates a data source reading from a standard input stream.
+/** WARNING: The stream is not owned by the source, you must keep it alive while the source is used. */
+BinarySourceFunc istreamSource( std::istream & is );
+
+
+//======================================================================================================================
+/// Binary input stream that keeps only a fixed-size window of the input data in memory and refills it when needed.
+/** Use this for parsing inputs that are too big to be loaded into memory at once. Whenever a read reaches past
+  * the data in the window, the already consumed data are discarded, the unread rest is moved to the beginning
+  * and the window is filled with new data from the source. A single read operation can't be larger than the window,
+  * such read fails the same way as a read past the end of the input.
+  *
+  * Note: Data returned by reference (spans, views) are valid only until the next read. Rewinding is only possible
+  * within the current window. */
+
+class RefillingBinaryInputStream : public BinaryInputStream
+{
+
+	BinarySourceFunc _source;
+	std::vector< uint8_t > _window;
+	size_t _discardedSize;  ///< how many bytes before the beginning of the window have already been consumed
+	bool _sourceEnded;  ///< the source has no more data
+
+ public:
+
+	static constexpr size_t c_defaultWindowSize = 64 * 1024;
+
+	explicit RefillingBinaryInputStream( BinarySourceFunc source, size_t windowSize = c_defaultWindowSize );
+
+	RefillingBinaryInputStream( RefillingBinaryInputStream && other ) noexcept;
+	RefillingBinaryInputStream & operator=( RefillingBinaryInputStream && other ) noexcept;
+
+	/// Returns how many bytes have been consumed from the source in total.
+	size_t offset() const noexcept
+	{
+		return _discardedSize + BinaryInputStream::offset();
+	}
+
+	/// Returns true when all the data from the source have been consumed.
+	bool isAtEnd() noexcept
+	{
+		return !refillIfEmpty();
+	}
+
+	/// Moves over specified number of bytes without returning them to the user.
+	/** Unlike other reads, this one can be larger than the window. */
+	bool skip( size_t numBytes ) noexcept;
+
+	/// Skips bytes until the total offset from the beginning of the source is a multiple of \p alignment.
+	bool alignTo( size_t alignment ) noexcept
+	{
+		return skip( paddingTo( offset(), alignment ) );
+	}
+
+	/// Reads all the remaining data from the source to a resizable container.
+	/** The container is automatically resized before copying the bytes into it. */
+	template< typename Cont,
+		REQUIRES( is_range_of_byte_alikes<Cont>::value && has_contiguous_data<Cont>::value && is_resizable<Cont>::value ) >
+	bool readRemaining( Cont & cont ) noexcept
+	{
+		size_t totalSize = 0;
+		while (!_failed && refillIfEmpty())
+		{
+			const size_t readSize = remaining();
+			cont.resize( totalSize + readSize );
+			copyBytes( _curPos, reinterpret_cast< uint8_t * >( fut::data( cont ) ) + totalSize, readSize );
+			_curPos += readSize;
+			totalSize += readSize;
+		}
+		return !_failed;
+	}
+
+ private:
+
+	// this stream must never point to a buffer it doesn't own, and it can't go back to data it has discarded
+	using BinaryInputStream::reset;
+	using BinaryInputStream::rewindToBeginning;
+	using BinaryInputStream::consumedBytes;  // would contain only the current window
+	// the refill moves the data within the window, so their addresses don't keep the alignment of their offsets
+	using BinaryInputStream::readLittleEndian_aligned;
+	using BinaryInputStream::readBigEndian_aligned;
+
+	/// Returns false if the window is empty and the source has no more data.
+	bool refillIfEmpty() noexcept
+	{
+		if (_curPos == _endPos)
+		{
+			refill( *this, 1 );
+		}
+		return _curPos != _endPos;
+	}
+
+	static void refill( BinaryInputStream & base, size_t requiredSize ) noexcept;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace own
+
+
+#endif // CPPUTILS_REFILLING_BINARY_STREAM_INCLUDED
@@ -32,9 +32,9 @@ enum class SafetyChecks
 	#if defined(DEBUG) && !defined(NOASSERT)
 		#define SAFETY_CHECK( condition, ... ) assert_msg( condition, CPPUTILS_GET_FIRST_ARG( __VA_ARGS__ ) )
 	#elif defined(CRITICALS_CATCHABLE)
-		#define SAFETY_CHECK( condition, ... ) if (condition) impl::throw_critical_error( __VA_ARGS__ )
+		#define SAFETY_CHECK( condition, ... ) if (!(condition)) ::impl::throw_critical_error( __VA_ARGS__ )
 	#else
-		#define SAFETY_CHECK( condition, ... ) if (condition) impl::abort_on_critical_error( __VA_ARGS__ )
+		#define SAFETY_CHECK( condition, ... ) if (!(condition)) ::impl::abort_on_critical_error( __VA_ARGS__ )
 	#endif
 #else
 	#define SAFETY_CHECK( condition, ... )
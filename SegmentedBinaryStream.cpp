@@ -0,0 +1,254 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: binary output stream that writes into a chain of memory blocks instead of one continuous buffer
+//======================================================================================================================
+
+#include "SegmentedBinaryStream.hpp"
+
+#include "MemAccessUtils.hpp"
+
+#include <new>  // bad_alloc
+
+
+namespace own {
+
+
+//======================================================================================================================
+// BinaryBlockPool
+
+constexpr size_t BinaryBlockPool::c_defaultBlockSize;
+
+std::unique_ptr< uint8_t [] > BinaryBlockPool::acquire()
+{
+	if (_freeBlocks.empty())
+	{
+		return std::unique_ptr< uint8_t [] >( new uint8_t [ _blockSize ] );
+	}
+	std::unique_ptr< uint8_t [] > block = std::move( _freeBlocks.back() );
+	_freeBlocks.pop_back();
+	return block;
+}
+
+void BinaryBlockPool::release( std::unique_ptr< uint8_t [] > block ) noexcept
+{
+	try
+	{
+		_freeBlocks.push_back( std::move( block ) );
+	}
+	catch (const std::bad_alloc &)
+	{
+		// the list of free blocks can't grow, so the block is just freed when the argument goes out of scope
+	}
+}
+
+
+//======================================================================================================================
+// SegmentedBinaryOutputStream
+
+// Makes room for \p count more elements in advance, so that the following push_backs can't fail.
+// Unlike reserving the exact size, it keeps the amortized constant cost of push_back.
+template< typename Elem >
+static void reserveGeometrically( std::vector< Elem > & vec, size_t count )
+{
+	if (vec.capacity() - vec.size() < count)
+	{
+		vec.reserve( 2 * vec.size() + count );
+	}
+}
+
+constexpr size_t SegmentedBinaryOutputStream::c_neverReference;
+
+SegmentedBinaryOutputStream::SegmentedBinaryOutputStream( size_t blockSize )
+	: BinaryOutputStream( byte_span(), &grow )
+	, _ownPool( new BinaryBlockPool( blockSize ) )
+	, _pool( _ownPool.get() )
+	, _segmentBeg( nullptr )
+	, _finishedSize( 0 )
+	, _referenceThreshold( c_neverReference )
+{}
+
+SegmentedBinaryOutputStream::SegmentedBinaryOutputStream( BinaryBlockPool & pool )
+	: BinaryOutputStream( byte_span(), &grow )
+	, _ownPool()
+	, _pool( &pool )
+	, _segmentBeg( nullptr )
+	, _finishedSize( 0 )
+	, _referenceThreshold( c_neverReference )
+{}
+
+SegmentedBinaryOutputStream::SegmentedBinaryOutputStream( SegmentedBinaryOutputStream && other ) noexcept
+	: BinaryOutputStream( std::move( other ) )
+	, _ownPool( std::move( other._ownPool ) )
+	, _pool( other._pool )
+	, _blocks( std::move( other._blocks ) )
+	, _segments( std::move( other._segments ) )
+	, _segmentBeg( other._segmentBeg )
+	, _finishedSize( other._finishedSize )
+	, _referenceThreshold( other._referenceThreshold )
+{
+	other._blocks.clear();
+	other.clear();
+	if (_ownPool)  // the other stream's own pool now belongs to this one
+	{
+		other._pool = nullptr;  // it will create a new one if it's written to again
+	}
+}
+
+SegmentedBinaryOutputStream & SegmentedBinaryOutputStream::operator=( SegmentedBinaryOutputStream && other ) noexcept
+{
+	if (this != &other)
+	{
+		clear();
+		BinaryOutputStream::operator=( std::move( other ) );
+		_ownPool = std::move( other._ownPool );
+		_pool = other._pool;
+		_blocks = std::move( other._blocks );
+		_segments = std::move( other._segments );
+		_segmentBeg = other._segmentBeg;
+		_finishedSize = other._finishedSize;
+		_referenceThreshold = other._referenceThreshold;
+
+		other._blocks.clear();
+		other.clear();
+		if (_ownPool)  // the other stream's own pool now belongs to this one
+		{
+			other._pool = nullptr;  // it will create a new one if it's written to again
+		}
+	}
+	return *this;
+}
+
+SegmentedBinaryOutputStream::~SegmentedBinaryOutputStream()
+{
+	clear();
+}
+
+void SegmentedBinaryOutputStream::writeReference( const_byte_span bytes )
+{
+	reserveGeometrically( _segments, 2 );  // so that the state remains consistent when the allocation fails
+	finishCurrentSegment();
+	_segments.push_back( bytes );
+	_finishedSize += bytes.size();
+}
+
+std::vector< const_byte_span > SegmentedBinaryOutputStream::segments() const
+{
+	std::vector< const_byte_span > segments;
+	segments.reserve( _segments.size() + 1 );
+	segments.insert( segments.end(), _segments.begin(), _segments.end() );
+	if (_curPos > _segmentBeg)
+	{
+		segments.emplace_back( _segmentBeg, _curPos );
+	}
+	return segments;
+}
+
+#ifdef CPPUTILS_HAS_IOVEC
+std::vector< struct iovec > SegmentedBinaryOutputStream::ioVectors() const
+{
+	std::vector< struct iovec > vectors;
+	vectors.reserve( _segments.size() + 1 );
+	for (const_byte_span segment : segments())
+	{
+		struct iovec vec;
+		vec.iov_base = const_cast< uint8_t * >( segment.data() );  // writev() doesn't modify it
+		vec.iov_len = segment.size();
+		vectors.push_back( vec );
+	}
+	return vectors;
+}
+#endif
+
+void SegmentedBinaryOutputStream::copyTo( byte_span buffer ) const noexcept
+{
+	// not using segments(), so that nothing is allocated
+	uint8_t * dstPos = buffer.data();
+	for (const_byte_span segment : _segments)
+	{
+		copyBytes( segment.data(), dstPos, segment.size() );
+		dstPos += segment.size();
+	}
+	copyBytes( _segmentBeg, dstPos, size_t( _curPos - _segmentBeg ) );
+}
+
+void SegmentedBinaryOutputStream::clear() noexcept
+{
+	for (Block & block : _blocks)
+	{
+		releaseBlock( block );
+	}
+	_blocks.clear();
+	_segments.clear();
+	_finishedSize = 0;
+	reset( byte_span() );
+	_segmentBeg = _curPos;
+}
+
+void SegmentedBinaryOutputStream::finishCurrentSegment()
+{
+	if (_curPos > _segmentBeg)
+	{
+		_segments.emplace_back( _segmentBeg, _curPos );
+		_finishedSize += size_t( _curPos - _segmentBeg );
+	}
+	_segmentBeg = _curPos;
+}
+
+void SegmentedBinaryOutputStream::startNewBlock( size_t requiredSize )
+{
+	// allocate everything first, so that an allocation failure leaves the stream in a consistent state
+	if (!_pool)  // the own pool has been moved to another stream
+	{
+		_ownPool.reset( new BinaryBlockPool );
+		_pool = _ownPool.get();
+	}
+	Block newBlock;
+	if (requiredSize <= _pool->blockSize())
+	{
+		newBlock.data = _pool->acquire();
+		newBlock.capacity = _pool->blockSize();
+	}
+	else
+	{
+		newBlock.data.reset( new uint8_t [ requiredSize ] );
+		newBlock.capacity = requiredSize;
+	}
+	reserveGeometrically( _blocks, 1 );
+	reserveGeometrically( _segments, 1 );
+
+	finishCurrentSegment();
+
+	// a block with nothing written in it can go back to the pool right away
+	if (!_blocks.empty() && _curPos == _begPos)
+	{
+		releaseBlock( _blocks.back() );
+		_blocks.pop_back();
+	}
+
+	_blocks.push_back( std::move( newBlock ) );
+	reset( byte_span( _blocks.back().data.get(), _blocks.back().capacity ) );
+	_segmentBeg = _curPos;
+}
+
+void SegmentedBinaryOutputStream::releaseBlock( Block & block ) noexcept
+{
+	// oversized blocks are not accepted by the pool, they will be freed
+	if (block.capacity == _pool->blockSize())
+	{
+		_pool->release( std::move( block.data ) );
+	}
+	block.data.reset();
+}
+
+void SegmentedBinaryOutputStream::grow( BinaryOutputStream & base, size_t requiredSize )
+{
+	static_cast< SegmentedBinaryOutputStream & >( base ).startNewBlock( requiredSize );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace own
@@ -0,0 +1,226 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: binary output stream that writes into a chain of memory blocks instead of one continuous buffer
+//======================================================================================================================
+
+#ifndef CPPUTILS_SEGMENTED_BINARY_STREAM_INCLUDED
+#define CPPUTILS_SEGMENTED_BINARY_STREAM_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "BinaryStream.hpp"
+#include "Span.hpp"
+
+#include <vector>
+#include <memory>  // unique_ptr
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <sys/uio.h>  // iovec
+	#define CPPUTILS_HAS_IOVEC
+#endif
+
+
+namespace own {
+
+
+//======================================================================================================================
+/// Pool of fixed-size memory blocks that can be shared by multiple segmented streams.
+/** Blocks returned by the streams are kept for later use instead of being freed, so that serializing many
+  * messages doesn't keep allocating and freeing the same memory over and over. */
+
+class BinaryBlockPool
+{
+
+	size_t _blockSize;
+	std::vector< std::unique_ptr< uint8_t [] > > _freeBlocks;
+
+ public:
+
+	static constexpr size_t c_defaultBlockSize = 64 * 1024;
+
+	explicit BinaryBlockPool( size_t blockSize = c_defaultBlockSize ) noexcept : _blockSize( blockSize ) {}
+
+	BinaryBlockPool( const BinaryBlockPool & ) = delete;
+	BinaryBlockPool & operator=( const BinaryBlockPool & ) = delete;
+
+	size_t blockSize() const noexcept  { return _blockSize; }
+
+	/// Returns how many free blocks are ready to be taken without allocating.
+	size_t numFreeBlocks() const noexcept  { return _freeBlocks.size(); }
+
+	/// Takes a block of blockSize() bytes from the pool, or allocates a new one if the pool is empty.
+	std::unique_ptr< uint8_t [] > acquire();
+
+	/// Gives a block of blockSize() bytes back to the pool.
+	/** If there is not enough memory to keep it in the pool, the block is freed. */
+	void release( std::unique_ptr< uint8_t [] > block ) noexcept;
+
+	/// Frees all the blocks currently held by the pool.
+	void clear() noexcept
+	{
+		_freeBlocks.clear();
+	}
+
+};
+
+
+//======================================================================================================================
+/// Binary output stream that chains fixed-size memory blocks instead of re-allocating one continuous buffer.
+/** When the current block is full, a new block is taken from a BinaryBlockPool and the writing continues there,
+  * so the already written data are never copied again. A single write is never split between two blocks,
+  * if it doesn't fit into the rest of the current block, the rest remains unused. Writes larger than the block size
+  * get a dedicated block of their own size.
+  * The result is obtained as a list of continuous segments via segments(), which is suitable for writev().
+  *
+  * Optionally, byte ranges above a configurable size can be recorded as references to the caller's memory
+  * instead of being copied into the blocks (see setReferenceThreshold()).
+  *
+  * Note: Methods of the base class that work with positions (offset(), remaining(), isAtEnd(), ...) relate
+  * only to the current block, unless they are overriden here. */
+
+class SegmentedBinaryOutputStream : public BinaryOutputStream
+{
+
+	struct Block
+	{
+		std::unique_ptr< uint8_t [] > data;
+		size_t capacity;
+	};
+
+	std::unique_ptr< BinaryBlockPool > _ownPool;  ///< used when the user doesn't provide any pool
+	BinaryBlockPool * _pool;
+	std::vector< Block > _blocks;  ///< storage owned by this stream, the last one is the one currently written to
+	std::vector< const_byte_span > _segments;  ///< finished segments, either parts of the blocks or references
+	const uint8_t * _segmentBeg;  ///< beginning of the segment currently being written, it ends at _curPos
+	size_t _finishedSize;  ///< total size of the finished segments
+	size_t _referenceThreshold;  ///< byte ranges of at least this size are referenced instead of copied
+
+ public:
+
+	/// Value of the reference threshold that disables referencing completely.
+	static constexpr size_t c_neverReference = size_t(-1);
+
+	/// Creates a stream with its own private pool of blocks of a given size.
+	explicit SegmentedBinaryOutputStream( size_t blockSize = BinaryBlockPool::c_defaultBlockSize );
+
+	/// Creates a stream that takes blocks from a shared pool.
+	/** WARNING: The pool must exist at least as long as this object. */
+	explicit SegmentedBinaryOutputStream( BinaryBlockPool & pool );
+
+	/// The written data move together with the own pool, so a moved-from stream that is written to again
+	/// creates a new own pool with the default block size.
+	SegmentedBinaryOutputStream( SegmentedBinaryOutputStream && other ) noexcept;
+	SegmentedBinaryOutputStream & operator=( SegmentedBinaryOutputStream && other ) noexcept;
+
+	~SegmentedBinaryOutputStream();
+
+	/// Returns how many bytes have been written in total.
+	size_t offset() const noexcept
+	{
+		return _finishedSize + size_t( _curPos - _segmentBeg );
+	}
+
+	/// Returns how many bytes have been written in total.
+	size_t size() const noexcept
+	{
+		return offset();
+	}
+
+	/// Writes zero bytes until the total offset is a multiple of \p alignment.
+	void alignTo( size_t alignment )
+	{
+		writeZeroBytes( paddingTo( offset(), alignment ) );
+	}
+
+	//-- zero-copy writing ---------------------------------------------------------------------------------------------
+
+	/// Sets the minimum size of a byte range written by writeBytes() or operator<< to be referenced instead of copied.
+	/** By default nothing is referenced.
+	  * WARNING: The referenced memory must stay valid until the data of this stream are consumed. */
+	void setReferenceThreshold( size_t minSize ) noexcept
+	{
+		_referenceThreshold = minSize;
+	}
+
+	size_t referenceThreshold() const noexcept
+	{
+		return _referenceThreshold;
+	}
+
+	/// Inserts a reference to an external memory range into the stream, instead of copying its content.
+	/** WARNING: The referenced memory must stay valid until the data of this stream are consumed. */
+	void writeReference( const_byte_span bytes );
+
+	/// Writes a range of bytes, either by copying them or by referencing them depending on the reference threshold.
+	template< typename Range, REQUIRES( is_range_of_byte_alikes<Range>::value && has_contiguous_data<Range>::value ) >
+	void writeBytes( const Range & bytes )
+	{
+		if (fut::size( bytes ) >= _referenceThreshold)
+			writeReference( make_span( reinterpret_cast< const uint8_t * >( fut::data( bytes ) ), fut::size( bytes ) ) );
+		else
+			BinaryOutputStream::writeBytes( bytes );
+	}
+
+	template< typename Range, REQUIRES( is_range_of_byte_alikes<Range>::value && has_contiguous_data<Range>::value ) >
+	SegmentedBinaryOutputStream & operator<<( const Range & bytes )
+	{
+		writeBytes( bytes );
+		return *this;
+	}
+
+	// override with different return value, so that the chained calls end up in this class again
+
+	template< typename Byte, REQUIRES( is_byte_alike<Byte>::value ) >
+	SegmentedBinaryOutputStream & operator<<( Byte b )
+	{
+		return static_cast< SegmentedBinaryOutputStream & >( BinaryOutputStream::operator<<( b ) );
+	}
+
+	//-- result --------------------------------------------------------------------------------------------------------
+
+	/// Returns all the written data as a sequence of continuous memory segments.
+	/** The segments remain valid until the stream is cleared or destroyed, or until the next write. */
+	std::vector< const_byte_span > segments() const;
+
+ #ifdef CPPUTILS_HAS_IOVEC
+	/// Returns all the written data as an array of I/O vectors ready to be passed to writev() or sendmsg().
+	/** The vectors remain valid until the stream is cleared or destroyed, or until the next write.
+	  * Note that the system limits the number of vectors per call to IOV_MAX. */
+	std::vector< struct iovec > ioVectors() const;
+ #endif
+
+	/// Copies all the written data into a single continuous buffer, which must be at least size() long.
+	void copyTo( byte_span buffer ) const noexcept;
+
+	/// Gives all the blocks back to the pool and moves the position to the beginning.
+	void clear() noexcept;
+
+ private:
+
+	using BinaryOutputStream::reset;  // this stream must never point to a buffer it doesn't own
+	using BinaryOutputStream::writtenBytes;  // would contain only the current block
+	using BinaryOutputStream::reserveField;  // the field would be addressed relative to the current block
+	// a write that doesn't fit into the current block moves to a new one, so the addresses don't keep the alignment
+	// of their offsets
+	using BinaryOutputStream::writeLittleEndian_aligned;
+	using BinaryOutputStream::writeBigEndian_aligned;
+
+	void finishCurrentSegment();
+	void startNewBlock( size_t requiredSize );
+	void releaseBlock( Block & block ) noexcept;
+
+	static void grow( BinaryOutputStream & base, size_t requiredSize );
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace own
+
+
+#endif // CPPUTILS_SEGMENTED_BINARY_STREAM_INCLUDED
@@ -0,0 +1,297 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: compile-time description of a binary layout of a struct for automatic serialization
+//======================================================================================================================
+
+#ifndef CPPUTILS_STRUCT_LAYOUT_INCLUDED
+#define CPPUTILS_STRUCT_LAYOUT_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "TypeTraits.hpp"  // is_endian_serializable
+#include "Endianity.hpp"
+#include "MemAccessUtils.hpp"
+
+#include <type_traits>
+#include <cstddef>  // offsetof
+
+
+// Usage:
+//
+//   struct Header { uint16_t type; uint16_t flags; uint32_t length; char tag [4]; };
+//
+//   using HeaderLayout = own::StructLayout< Header, own::Endianity::Big,
+//       CPPUTILS_FIELD( Header, type ),
+//       CPPUTILS_FIELD( Header, flags ),
+//       CPPUTILS_FIELD( Header, length ),
+//       CPPUTILS_FIELD( Header, tag )
+//   >;
+//
+//   stream.writeStruct< HeaderLayout >( header );
+//   stream.readStruct< HeaderLayout >( header );
+
+
+/// Describes a member of a struct as a field of its binary layout, to be used as template argument of StructLayout.
+/** The offset of the member is captured by offsetof, so the struct should be a standard-layout type. */
+#define CPPUTILS_FIELD( Struct, member ) \
+	::own::Field< Struct, decltype( Struct::member ), &Struct::member, offsetof( Struct, member ) >
+
+
+namespace own {
+
+
+//======================================================================================================================
+// private implementation details
+
+namespace impl {
+
+/// Encodes and decodes a single member according to its type, supports numbers and fixed-size arrays of numbers.
+template< typename Type, typename Enable = void >
+struct FieldCodec;  // other types are not supported, they have no defined binary representation
+
+template< typename Type >
+struct FieldCodec< Type, typename std::enable_if< is_endian_serializable<Type>::value >::type >
+{
+	template< Endianity endianity >
+	static void encode( uint8_t * bufferPos, const Type & value ) noexcept
+	{
+		writeWithEndianity< endianity >( bufferPos, value );
+	}
+
+	template< Endianity endianity >
+	static void decode( const uint8_t * bufferPos, Type & value ) noexcept
+	{
+		value = readWithEndianity< endianity, Type >( bufferPos );
+	}
+};
+
+template< typename Element, size_t count >
+struct FieldCodec< Element [count], typename std::enable_if< is_endian_serializable<Element>::value >::type >
+{
+	template< Endianity endianity >
+	static void encode( uint8_t * bufferPos, const Element (& array) [count] ) noexcept
+	{
+		writeArrayWithEndianity< endianity >( bufferPos, array, count );
+	}
+
+	template< Endianity endianity >
+	static void decode( const uint8_t * bufferPos, Element (& array) [count] ) noexcept
+	{
+		readArrayWithEndianity< endianity >( bufferPos, array, count );
+	}
+};
+
+} // namespace impl
+
+
+//======================================================================================================================
+/// Single member of a struct described as a field of its binary layout.
+/** Preffer using the CPPUTILS_FIELD macro instead of writing the template arguments manually. */
+
+template< typename Struct, typename MemberType, MemberType Struct::* member, size_t offset >
+struct Field
+{
+	using struct_type = Struct;
+	using member_type = MemberType;
+
+	/// Size of the field in the encoded form.
+	static constexpr size_t c_size = sizeof( MemberType );
+
+	/// Offset of the member in the struct.
+	static constexpr size_t c_offsetInStruct = offset;
+
+	template< Endianity endianity >
+	static void encode( const Struct & obj, uint8_t * bufferPos ) noexcept
+	{
+		impl::FieldCodec< MemberType >::template encode< endianity >( bufferPos, obj.*member );
+	}
+
+	template< Endianity endianity >
+	static void decode( const uint8_t * bufferPos, Struct & obj ) noexcept
+	{
+		impl::FieldCodec< MemberType >::template decode< endianity >( bufferPos, obj.*member );
+	}
+
+	/// Decodes only the value of the member, without a struct to store it in.
+	template< Endianity endianity >
+	static void decodeValue( const uint8_t * bufferPos, MemberType & value ) noexcept
+	{
+		impl::FieldCodec< MemberType >::template decode< endianity >( bufferPos, value );
+	}
+};
+
+template< typename Struct, typename MemberType, MemberType Struct::* member, size_t offset >
+constexpr size_t Field< Struct, MemberType, member, offset >::c_size;
+
+template< typename Struct, typename MemberType, MemberType Struct::* member, size_t offset >
+constexpr size_t Field< Struct, MemberType, member, offset >::c_offsetInStruct;
+
+
+//======================================================================================================================
+// private implementation details
+
+namespace impl {
+
+/// Recursively expands the operations over all the fields, so that the compiler can inline all of them.
+template< typename Struct, typename ... Fields >
+struct FieldSequence;
+
+template< typename Struct >
+struct FieldSequence< Struct >
+{
+	static constexpr size_t c_size = 0;
+
+	template< Endianity endianity >
+	static void encode( const Struct &, uint8_t * ) noexcept {}
+
+	template< Endianity endianity >
+	static void decode( const uint8_t *, Struct & ) noexcept {}
+
+	static constexpr bool isContiguousFrom( size_t ) noexcept
+	{
+		return true;
+	}
+};
+
+template< typename Struct, typename FirstField, typename ... OtherFields >
+struct FieldSequence< Struct, FirstField, OtherFields ... >
+{
+	static_assert( std::is_same< typename FirstField::struct_type, Struct >::value, "the field belongs to a different struct" );
+
+	using Rest = FieldSequence< Struct, OtherFields ... >;
+
+	static constexpr size_t c_size = FirstField::c_size + Rest::c_size;
+
+	template< Endianity endianity >
+	static void encode( const Struct & obj, uint8_t * bufferPos ) noexcept
+	{
+		FirstField::template encode< endianity >( obj, bufferPos );
+		Rest::template encode< endianity >( obj, bufferPos + FirstField::c_size );
+	}
+
+	template< Endianity endianity >
+	static void decode( const uint8_t * bufferPos, Struct & obj ) noexcept
+	{
+		FirstField::template decode< endianity >( bufferPos, obj );
+		Rest::template decode< endianity >( bufferPos + FirstField::c_size, obj );
+	}
+
+	/// Whether the fields follow each other in the struct in the same order and without any gaps.
+	static constexpr bool isContiguousFrom( size_t offset ) noexcept
+	{
+		return FirstField::c_offsetInStruct == offset && Rest::isContiguousFrom( offset + FirstField::c_size );
+	}
+};
+
+/// Offset of a field in the encoded form, which is the total size of the fields preceding it.
+template< size_t fieldIdx, typename ... Fields >
+struct EncodedFieldOffset;
+
+template< typename FirstField, typename ... OtherFields >
+struct EncodedFieldOffset< 0, FirstField, OtherFields ... >
+{
+	static constexpr size_t value = 0;
+};
+
+template< size_t fieldIdx, typename FirstField, typename ... OtherFields >
+struct EncodedFieldOffset< fieldIdx, FirstField, OtherFields ... >
+{
+	static constexpr size_t value = FirstField::c_size + EncodedFieldOffset< fieldIdx - 1, OtherFields ... >::value;
+};
+
+} // namespace impl
+
+
+//======================================================================================================================
+/// Compile-time description of a binary layout of a struct, generating inlined encoding and decoding routines.
+/** The fields are encoded one after another without any padding, in the order in which they are listed,
+  * numbers are converted to the selected endianity. The total size of the encoded struct is known at compile time,
+  * so the streams need only a single bounds check for the whole struct.
+  * When the selected endianity is the native one and the struct is trivially copyable and standard-layout with all
+  * its members listed in the declaration order and without any padding, the whole struct is copied at once.
+  * This is decided at compile time. */
+
+template< typename Struct, Endianity endianity, typename ... Fields >
+class StructLayout
+{
+
+	using Sequence = impl::FieldSequence< Struct, Fields ... >;
+
+ public:
+
+	using struct_type = Struct;
+
+	/// Endianity of the encoded numbers.
+	static constexpr Endianity c_endianity = endianity;
+
+	/// Size of the whole struct in the encoded form.
+	static constexpr size_t c_size = Sequence::c_size;
+
+	/// Number of the described fields.
+	static constexpr size_t c_numFields = sizeof...( Fields );
+
+	/// Field of the given index in the order in which the fields are listed.
+	template< size_t fieldIdx >
+	using field = typename get_nth_type< fieldIdx, Fields ... >::type;
+
+	/// Offset of the field of the given index in the encoded form.
+	template< size_t fieldIdx >
+	static constexpr size_t fieldOffset() noexcept
+	{
+		return impl::EncodedFieldOffset< fieldIdx, Fields ... >::value;
+	}
+
+	/// Encodes the struct into the buffer.
+	/** NOTE: This function performs no boundary checking, the buffer must have at least c_size bytes.
+	  * Preffer using BinaryOutputStream::writeStruct() whenever possible. */
+	static void encode( const Struct & obj, uint8_t * bufferPos ) noexcept
+	{
+		IF_CONSTEXPR (isMemoryIdentical())
+			copyBytes( reinterpret_cast< const uint8_t * >( &obj ), bufferPos, c_size );
+		else
+			Sequence::template encode< endianity >( obj, bufferPos );
+	}
+
+	/// Decodes the struct from the buffer.
+	/** NOTE: This function performs no boundary checking, the buffer must have at least c_size bytes.
+	  * Preffer using BinaryInputStream::readStruct() whenever possible. */
+	static void decode( const uint8_t * bufferPos, Struct & obj ) noexcept
+	{
+		IF_CONSTEXPR (isMemoryIdentical())
+			copyBytes( bufferPos, reinterpret_cast< uint8_t * >( &obj ), c_size );
+		else
+			Sequence::template decode< endianity >( bufferPos, obj );
+	}
+
+	/// Whether the encoded form is identical to the representation of the struct in memory.
+	static constexpr bool isMemoryIdentical() noexcept
+	{
+		return endianity == c_thisCpuEndianity
+			&& std::is_trivially_copyable< Struct >::value
+			&& std::is_standard_layout< Struct >::value
+			&& sizeof( Struct ) == c_size
+			&& Sequence::isContiguousFrom( 0 );
+	}
+
+};
+
+template< typename Struct, Endianity endianity, typename ... Fields >
+constexpr Endianity StructLayout< Struct, endianity, Fields ... >::c_endianity;
+
+template< typename Struct, Endianity endianity, typename ... Fields >
+constexpr size_t StructLayout< Struct, endianity, Fields ... >::c_size;
+
+template< typename Struct, Endianity endianity, typename ... Fields >
+constexpr size_t StructLayout< Struct, endianity, Fields ... >::c_numFields;
+
+
+//======================================================================================================================
+
+
+} // namespace own
+
+
+#endif // CPPUTILS_STRUCT_LAYOUT_INCLUDED
@@ -0,0 +1,135 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: pool of worker threads for splitting work into parallel tasks
+//======================================================================================================================
+
+#include "ThreadPool.hpp"
+
+
+namespace own {
+
+
+ThreadPool::ThreadPool( size_t numThreads )
+	: _func( nullptr ), _numTasks( 0 ), _nextTask( 0 ), _unfinishedTasks( 0 ), _stopping( false )
+{
+	try
+	{
+		for (size_t i = 1; i < numThreads; ++i)
+		{
+			_workers.emplace_back( &ThreadPool::workerLoop, this );
+		}
+	}
+	catch (...)
+	{
+		// destroying the threads that are already running would terminate the program
+		stopWorkers();
+		throw;
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	stopWorkers();
+}
+
+void ThreadPool::stopWorkers() noexcept
+{
+	{
+		std::lock_guard< std::mutex > lock( _mutex );
+		_stopping = true;
+	}
+	_tasksAvailable.notify_all();
+	for (std::thread & worker : _workers)
+	{
+		worker.join();
+	}
+}
+
+size_t ThreadPool::defaultNumThreads() noexcept
+{
+	const unsigned int numCores = std::thread::hardware_concurrency();
+	return numCores > 0 ? numCores : 1;  // 0 means it's not known
+}
+
+void ThreadPool::runParallel( size_t numTasks, const std::function< void ( size_t taskIdx ) > & func )
+{
+	if (_workers.empty() || numTasks <= 1)  // no need to involve other threads
+	{
+		for (size_t taskIdx = 0; taskIdx < numTasks; ++taskIdx)
+			func( taskIdx );
+		return;
+	}
+
+	std::lock_guard< std::mutex > runLock( _runMutex );
+	std::unique_lock< std::mutex > lock( _mutex );
+
+	_func = &func;
+	_numTasks = numTasks;
+	_nextTask = 0;
+	_unfinishedTasks = numTasks;
+	_tasksAvailable.notify_all();
+
+	executeTasks( lock );
+	_tasksFinished.wait( lock, [ this ]() { return _unfinishedTasks == 0; } );
+
+	_func = nullptr;
+	_numTasks = 0;
+	_nextTask = 0;
+	std::exception_ptr exception = _exception;
+	_exception = nullptr;
+	lock.unlock();
+
+	if (exception)
+	{
+		std::rethrow_exception( exception );
+	}
+}
+
+void ThreadPool::workerLoop()
+{
+	std::unique_lock< std::mutex > lock( _mutex );
+	while (true)
+	{
+		_tasksAvailable.wait( lock, [ this ]() { return _stopping || _nextTask < _numTasks; } );
+		if (_stopping)
+		{
+			return;
+		}
+		executeTasks( lock );
+	}
+}
+
+void ThreadPool::executeTasks( std::unique_lock< std::mutex > & lock )
+{
+	while (_nextTask < _numTasks)
+	{
+		const size_t taskIdx = _nextTask++;
+		const auto & func = *_func;
+		lock.unlock();
+
+		std::exception_ptr exception;
+		try
+		{
+			func( taskIdx );
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+
+		lock.lock();
+		if (exception && !_exception)
+		{
+			_exception = exception;
+		}
+		if (--_unfinishedTasks == 0)
+		{
+			_tasksFinished.notify_all();
+		}
+	}
+}
+
+
+} // namespace own
@@ -0,0 +1,90 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: pool of worker threads for splitting work into parallel tasks
+//======================================================================================================================
+
+#ifndef CPPUTILS_THREAD_POOL_INCLUDED
+#define CPPUTILS_THREAD_POOL_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+
+namespace own {
+
+
+//======================================================================================================================
+/// Fixed set of threads that execute indexed tasks of a parallel operation.
+/** The threads are started once in the constructor and wait for work, so that a parallel operation doesn't pay
+  * for creating threads. The thread calling runParallel() executes the tasks too, instead of just waiting.
+  * Only one parallel operation runs at a time, concurrent calls of runParallel() wait for each other. */
+
+class ThreadPool
+{
+
+	std::vector< std::thread > _workers;
+
+	std::mutex _runMutex;  ///< serializes the parallel operations
+	std::mutex _mutex;  ///< protects all the following members
+	std::condition_variable _tasksAvailable;
+	std::condition_variable _tasksFinished;
+	const std::function< void ( size_t ) > * _func;  ///< task function of the current operation
+	size_t _numTasks;  ///< number of tasks of the current operation, 0 if nothing is running
+	size_t _nextTask;  ///< index of the next task that nobody has taken yet
+	size_t _unfinishedTasks;
+	std::exception_ptr _exception;  ///< the first exception thrown by a task of the current operation
+	bool _stopping;
+
+ public:
+
+	/// Creates a pool where the tasks are executed by \p numThreads threads, including the thread calling runParallel().
+	/** By default it's the number of CPU cores.
+	  * If a thread can't be started, the already started ones are stopped and the exception is propagated. */
+	explicit ThreadPool( size_t numThreads = defaultNumThreads() );
+
+	ThreadPool( const ThreadPool & ) = delete;
+	ThreadPool & operator=( const ThreadPool & ) = delete;
+
+	~ThreadPool();
+
+	/// Number of threads executing the tasks, including the thread calling runParallel().
+	size_t numThreads() const noexcept
+	{
+		return _workers.size() + 1;
+	}
+
+	/// Returns the number of threads the hardware can execute in parallel.
+	static size_t defaultNumThreads() noexcept;
+
+	/// Calls \p func with every task index from 0 to \p numTasks - 1 distributed among the threads,
+	/// and waits until all the tasks are finished.
+	/** If some tasks throw an exception, the rest of the tasks is still executed, and then the first exception
+	  * is re-thrown from here. The tasks must not call runParallel() on the same pool. */
+	void runParallel( size_t numTasks, const std::function< void ( size_t taskIdx ) > & func );
+
+ private:
+
+	void workerLoop();
+
+	// makes all the workers exit and waits for them
+	void stopWorkers() noexcept;
+
+	// executes the tasks of the current operation until there are no more, the lock is released while executing
+	void executeTasks( std::unique_lock< std::mutex > & lock );
+
+};
+
+
+} // namespace own
+
+
+#endif // CPPUTILS_THREAD_POOL_INCLUDED
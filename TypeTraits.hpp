@@ -88,6 +88,22 @@ struct is_int_or_enum
 	static constexpr bool value = std::is_integral<T>::value || std::is_enum<T>::value;
 };
 
+/// This determines types that can be serialized using selected endianity rules, including floating point numbers.
+/** The floating point numbers are serialized as their bit representation in IEEE 754 format. */
+template< typename T >
+struct is_endian_serializable
+{
+	using T_ = typename std::remove_cv<T>::type;
+	static constexpr bool value = is_int_or_enum<T_>::value
+		|| std::is_same< T_, float >::value
+		|| std::is_same< T_, double >::value
+	 #ifdef CPPUTILS_HAS_INT128
+		|| std::is_same< T_, int128 >::value
+		|| std::is_same< T_, uint128 >::value
+	 #endif
+	;
+};
+
 /// Determines whether a type can be interpreted and serialized as a byte (char, unsigned char, uint8_t, std::byte, ...)
 template< typename T >
 struct is_byte_alike
@@ -132,6 +148,17 @@ struct bigger_type
 	>::type;
 };
 
+/// Unsigned integer type of a specific size in bytes.
+template< size_t size >
+struct uint_of_size {};
+template<> struct uint_of_size< 1 > { using type = uint8_t; };
+template<> struct uint_of_size< 2 > { using type = uint16_t; };
+template<> struct uint_of_size< 4 > { using type = uint32_t; };
+template<> struct uint_of_size< 8 > { using type = uint64_t; };
+#ifdef CPPUTILS_HAS_INT128
+template<> struct uint_of_size< 16 > { using type = uint128; };
+#endif
+
 template< typename SrcT, typename DstT >
 struct corresponding_constness
 {
@@ -268,6 +295,28 @@ struct is_trivial_range
 	static constexpr bool value = _is_trivial_range<T>();
 };
 
+template< typename T >
+struct is_endian_serializable_range
+{
+ private:
+
+	template< typename T_, REQUIRES( is_range<T_>::value ) >
+	static constexpr bool _is_endian_serializable_range()
+	{
+		return is_endian_serializable< typename range_element<T_>::type >::value;
+	}
+
+	template< typename T_, REQUIRES( !is_range<T_>::value ) >
+	static constexpr bool _is_endian_serializable_range()
+	{
+		return false;
+	}
+
+ public:
+
+	static constexpr bool value = _is_endian_serializable_range<T>();
+};
+
 template< typename T >
 struct is_range_of_byte_alikes
 {
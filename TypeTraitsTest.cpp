@@ -45,6 +45,17 @@ static_assert( is_int_or_enum< Enum >::value, "" );
 static_assert( is_int_or_enum< uint8_t >::value, "" );
 static_assert( !is_int_or_enum< float >::value, "" );
 
+static_assert( is_endian_serializable< int >::value, "" );
+static_assert( is_endian_serializable< Enum >::value, "" );
+static_assert( is_endian_serializable< float >::value, "" );
+static_assert( is_endian_serializable< const double >::value, "" );
+static_assert( !is_endian_serializable< long double >::value, "" );
+static_assert( !is_endian_serializable< int * >::value, "" );
+#ifdef CPPUTILS_HAS_INT128
+static_assert( is_endian_serializable< int128 >::value, "" );
+static_assert( is_endian_serializable< uint128 >::value, "" );
+#endif
+
 static_assert( is_byte_alike< uint8_t >::value, "" );
 static_assert( is_byte_alike< char >::value, "" );
 static_assert( !is_byte_alike< uint16_t >::value, "" );
@@ -64,6 +75,12 @@ static_assert( std::is_same< bigger_type< uint64_t, uint32_t >::type, uint64_t >
 static_assert( std::is_same< bigger_type< char, wchar_t >::type, wchar_t >::value, "" );
 static_assert( std::is_same< bigger_type< float, double >::type, double >::value, "" );
 
+static_assert( std::is_same< uint_of_size< 1 >::type, uint8_t >::value, "" );
+static_assert( std::is_same< uint_of_size< 2 >::type, uint16_t >::value, "" );
+static_assert( std::is_same< uint_of_size< sizeof( int32_t ) >::type, uint32_t >::value, "" );
+static_assert( std::is_same< uint_of_size< sizeof( Enum ) >::type, uint32_t >::value, "" );
+static_assert( std::is_same< uint_of_size< 8 >::type, uint64_t >::value, "" );
+
 static_assert( std::is_same< corresponding_constness< const char, int >::type, const int >::value, "" );
 static_assert( !std::is_same< corresponding_constness< const char, int >::type, int >::value, "" );
 static_assert( std::is_same< corresponding_constness< char, const int >::type, int >::value, "" );
@@ -83,6 +100,7 @@ static_assert( !is_range_of< CharCArr, uint8_t >::value, "" );
 static_assert( is_contiguous_range< CharCArr >::value, "" );
 static_assert( !is_resizable< CharCArr >::value, "" );
 static_assert( is_trivial_range< CharCArr >::value, "" );
+static_assert( is_endian_serializable_range< CharCArr >::value, "" );
 
 using CharArr = std::array< char, 4 >;
 static_assert( is_range< CharArr >::value, "" );
@@ -91,6 +109,7 @@ static_assert( !is_range_of< CharArr, uint8_t >::value, "" );
 static_assert( is_contiguous_range< CharArr >::value, "" );
 static_assert( !is_resizable< CharArr >::value, "" );
 static_assert( is_trivial_range< CharArr >::value, "" );
+static_assert( is_endian_serializable_range< CharArr >::value, "" );
 
 using CharVec = std::vector< char >;
 static_assert( is_range< CharVec >::value, "" );
@@ -99,6 +118,7 @@ static_assert( !is_range_of< CharVec, uint8_t >::value, "" );
 static_assert( is_contiguous_range< CharVec >::value, "" );
 static_assert( is_resizable< CharVec >::value, "" );
 static_assert( is_trivial_range< CharVec >::value, "" );
+static_assert( is_endian_serializable_range< CharVec >::value, "" );
 
 using CharList = std::list< char >;
 static_assert( is_range< CharList >::value, "" );
@@ -107,6 +127,7 @@ static_assert( !is_range_of< CharList, uint8_t >::value, "" );
 static_assert( !is_contiguous_range< CharList >::value, "" );
 static_assert( is_resizable< CharList >::value, "" );
 static_assert( is_trivial_range< CharList >::value, "" );
+static_assert( is_endian_serializable_range< CharList >::value, "" );
 
 using StringVec = std::vector< std::string >;
 static_assert( is_range< StringVec >::value, "" );
@@ -115,6 +136,12 @@ static_assert( !is_range_of< StringVec, uint8_t >::value, "" );
 static_assert( is_contiguous_range< StringVec >::value, "" );
 static_assert( is_resizable< StringVec >::value, "" );
 static_assert( !is_trivial_range< StringVec >::value, "" );
+static_assert( !is_endian_serializable_range< StringVec >::value, "" );
+
+using EnumVec = std::vector< Enum >;
+static_assert( is_endian_serializable_range< EnumVec >::value, "" );
+static_assert( is_endian_serializable_range< std::vector< double > >::value, "" );
+static_assert( !is_endian_serializable_range< std::vector< long double > >::value, "" );
 
 static_assert( is_c_array< CharCArr >::value, "" );
 static_assert( is_c_array_of< CharCArr, char >::value, "" );
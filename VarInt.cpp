@@ -0,0 +1,47 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: variable-length integer encoding (LEB128 and ZigZag)
+//======================================================================================================================
+
+#include "VarInt.hpp"
+
+
+namespace own {
+
+namespace impl {
+
+
+size_t decodeVarUInt_slow( const uint8_t * pos, const uint8_t * endPos, uint64_t & value ) noexcept
+{
+	constexpr size_t maxSize = max_varint_size< uint64_t >::value;
+
+	uint64_t result = 0;
+	size_t offset = 0;
+	while (offset < maxSize && pos + offset < endPos)
+	{
+		const uint8_t byte = pos[ offset ];
+		if (offset == maxSize - 1 && byte > 1)
+		{
+			return 0;  // the number doesn't fit into 64 bits
+		}
+		result |= uint64_t( byte & 0x7F ) << (7 * offset);
+		++offset;
+		if (!(byte & 0x80))
+		{
+			if (byte == 0 && offset > 1)
+			{
+				return 0;  // overlong encoding, the last byte adds no bits
+			}
+			value = result;
+			return offset;
+		}
+	}
+	return 0;  // truncated or too long
+}
+
+
+} // namespace impl
+
+} // namespace own
@@ -0,0 +1,196 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: variable-length integer encoding (LEB128 and ZigZag)
+//======================================================================================================================
+
+#ifndef CPPUTILS_VARINT_INCLUDED
+#define CPPUTILS_VARINT_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "TypeTraits.hpp"  // REQUIRES
+#include "MathUtils.hpp"   // countLeadingZeros, countTrailingZeros
+#include "Endianity.hpp"   // readLittleEndian
+
+#include <limits>
+
+
+namespace own {
+
+
+// Each byte of the encoding carries 7 bits of the number, starting with the least significant ones,
+// and its highest bit signals whether another byte follows. Numbers smaller than 128 take a single byte.
+
+
+/// Maximum number of bytes the variable-length encoding of an integer type can take.
+template< typename Int >
+struct max_varint_size
+{
+	static constexpr size_t value = (sizeof( Int ) * 8 + 6) / 7;
+};
+
+
+//======================================================================================================================
+// ZigZag
+
+/// Maps a signed integer to unsigned so that numbers with a small absolute value have a short encoding.
+/** 0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3, 2 -> 4, ... */
+template< typename Int, REQUIRES( std::is_integral<Int>::value && std::is_signed<Int>::value ) >
+constexpr typename std::make_unsigned< Int >::type zigZagEncode( Int value ) noexcept
+{
+	using UInt = typename std::make_unsigned< Int >::type;
+	return UInt( UInt( value ) << 1 ) ^ UInt( value >> (sizeof( Int ) * 8 - 1) );
+}
+
+/// Inverse of zigZagEncode().
+template< typename UInt, REQUIRES( std::is_integral<UInt>::value && std::is_unsigned<UInt>::value ) >
+constexpr typename std::make_signed< UInt >::type zigZagDecode( UInt value ) noexcept
+{
+	using Int = typename std::make_signed< UInt >::type;
+	return Int( UInt( value >> 1 ) ^ UInt( UInt(0) - UInt( value & 1 ) ) );
+}
+
+
+//======================================================================================================================
+// encoding and decoding - private implementation details
+
+namespace impl {
+
+/// General decoding loop for numbers of any length, returns the number of consumed bytes or 0 on error.
+size_t decodeVarUInt_slow( const uint8_t * pos, const uint8_t * endPos, uint64_t & value ) noexcept;
+
+/// Decodes a number of at most 8 bytes without any branches, \p pos must have at least 8 readable bytes.
+/** Returns the number of consumed bytes, or 0 if the number is longer than 8 bytes or if it's an overlong encoding.
+  * In both cases the caller is supposed to fall back to decodeVarUInt_slow(), which tells them apart. */
+inline size_t decodeVarUInt_8bytes( const uint8_t * pos, uint64_t & value ) noexcept
+{
+	const uint64_t word = readLittleEndian< uint64_t >( pos );
+	const uint64_t stopBits = ~word & 0x8080808080808080;  // the bytes which don't have a continuation bit
+	if (stopBits == 0)
+		return 0;
+	const size_t length = (countTrailingZeros( stopBits ) + 1) / 8;
+	const uint8_t lastByte = uint8_t( word >> (8 * (length - 1)) );
+	if (lastByte == 0 && length > 1)
+		return 0;
+
+	// keep only the bytes belonging to this number without their continuation bits
+	uint64_t bits = word & (stopBits ^ (stopBits - 1)) & 0x7F7F7F7F7F7F7F7F;
+	// and squeeze the 7-bit groups together, doubling the group size in each step
+	bits = ((bits & 0x7F007F007F007F00) >> 1) | (bits & 0x007F007F007F007F);
+	bits = ((bits & 0x3FFF00003FFF0000) >> 2) | (bits & 0x00003FFF00003FFF);
+	bits = ((bits & 0x0FFFFFFF00000000) >> 4) | (bits & 0x000000000FFFFFFF);
+
+	value = bits;
+	return length;
+}
+
+} // namespace impl
+
+
+//======================================================================================================================
+// encoding and decoding - public API
+// NOTE: The encoding functions perform no boundary checking, caller must ensure there is enough space in the buffer
+//       to do the write. Preffer using BinaryStream.h whenever possible.
+
+/// Returns how many bytes the variable-length encoding of a number takes.
+template< typename UInt, REQUIRES( std::is_integral<UInt>::value && std::is_unsigned<UInt>::value ) >
+inline size_t varUIntSize( UInt value ) noexcept
+{
+	static_assert( sizeof( UInt ) <= sizeof( uint64_t ), "numbers larger than 64 bits are not supported" );
+	const size_t numBits = 64 - countLeadingZeros( uint64_t( value ) | 1 );
+	return (numBits + 6) / 7;
+}
+
+/// Writes an unsigned number in the variable-length format and returns how many bytes it has written.
+template< typename UInt, REQUIRES( std::is_integral<UInt>::value && std::is_unsigned<UInt>::value ) >
+inline size_t encodeVarUInt( uint8_t * bufferPos, UInt value ) noexcept
+{
+	static_assert( sizeof( UInt ) <= sizeof( uint64_t ), "numbers larger than 64 bits are not supported" );
+	size_t offset = 0;
+	while (value >= 0x80) {
+		bufferPos[ offset ] = uint8_t( value | 0x80 );
+		value = UInt( value >> 7 );
+		++offset;
+	}
+	bufferPos[ offset ] = uint8_t( value );
+	return offset + 1;
+}
+
+/// Reads an unsigned number in the variable-length format from a buffer ending at \p endPos.
+/** Returns how many bytes it has consumed, or 0 if the encoding is truncated, overlong (has redundant trailing zero
+  * groups), or the number doesn't fit into UInt. */
+template< typename UInt, REQUIRES( std::is_integral<UInt>::value && std::is_unsigned<UInt>::value ) >
+inline size_t decodeVarUInt( const uint8_t * bufferPos, const uint8_t * endPos, UInt & value ) noexcept
+{
+	static_assert( sizeof( UInt ) <= sizeof( uint64_t ), "numbers larger than 64 bits are not supported" );
+	// fast path for the most common short numbers
+	if (bufferPos < endPos && bufferPos[0] < 0x80)
+	{
+		value = UInt( bufferPos[0] );
+		return 1;
+	}
+	uint64_t value64;
+	size_t length;
+	if (endPos - bufferPos >= 2 && bufferPos[1] != 0 && bufferPos[1] < 0x80)
+	{
+		value64 = uint64_t( bufferPos[0] & 0x7F ) | (uint64_t( bufferPos[1] ) << 7);
+		length = 2;
+	}
+	else
+	{
+		length = impl::decodeVarUInt_slow( bufferPos, endPos, value64 );
+	}
+	if (length == 0 || value64 > std::numeric_limits< UInt >::max())
+	{
+		return 0;
+	}
+	value = UInt( value64 );
+	return length;
+}
+
+/// Decodes \p count unsigned numbers in the variable-length format from a buffer ending at \p endPos.
+/** Returns the position after the last decoded number, or nullptr if any of them is invalid. */
+template< typename UInt, REQUIRES( std::is_integral<UInt>::value && std::is_unsigned<UInt>::value ) >
+const uint8_t * decodeVarUIntArray( const uint8_t * bufferPos, const uint8_t * endPos, UInt * values, size_t count ) noexcept
+{
+	static_assert( sizeof( UInt ) <= sizeof( uint64_t ), "numbers larger than 64 bits are not supported" );
+	size_t i = 0;
+
+	// as long as there are at least 8 readable bytes, numbers up to 8 bytes can be decoded without branching
+	while (i < count && endPos - bufferPos >= 8)
+	{
+		uint64_t value64;
+		size_t length = impl::decodeVarUInt_8bytes( bufferPos, value64 );
+		if (length == 0)  // 9 bytes or more, rare
+			length = impl::decodeVarUInt_slow( bufferPos, endPos, value64 );
+		if (length == 0 || value64 > std::numeric_limits< UInt >::max())
+			return nullptr;
+		values[ i ] = UInt( value64 );
+		bufferPos += length;
+		++i;
+	}
+
+	// the rest near the end of the buffer
+	while (i < count)
+	{
+		const size_t length = decodeVarUInt( bufferPos, endPos, values[ i ] );
+		if (length == 0)
+			return nullptr;
+		bufferPos += length;
+		++i;
+	}
+
+	return bufferPos;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace own
+
+
+#endif // CPPUTILS_VARINT_INCLUDED
@@ -0,0 +1,128 @@
+//======================================================================================================================
+// Project: CppUtils
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: unit tests for VarInt.hpp
+//======================================================================================================================
+
+#include "VarInt.hpp"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace own;
+
+
+static int g_numFailures = 0;
+
+#define CHECK( condition ) \
+	do { \
+		if (!(condition)) { \
+			std::printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition ); \
+			++g_numFailures; \
+		} \
+	} while (false)
+
+
+// numbers of all encoded lengths, including the boundaries between them
+static std::vector< uint64_t > testNumbers()
+{
+	std::vector< uint64_t > numbers = { 0, 1, 0x7F, 0x80, 0xFF, 0x3FFF, 0x4000, ~uint64_t(0), ~uint64_t(0) - 1 };
+	std::mt19937_64 random( 12345 );
+	for (unsigned int numBits = 1; numBits <= 64; ++numBits)
+	{
+		const uint64_t mask = numBits < 64 ? (uint64_t(1) << numBits) - 1 : ~uint64_t(0);
+		numbers.push_back( mask );
+		numbers.push_back( uint64_t(1) << (numBits - 1) );
+		for (int i = 0; i < 50; ++i)
+			numbers.push_back( (random() & mask) | (uint64_t(1) << (numBits - 1)) );
+	}
+	return numbers;
+}
+
+static void testRoundTrip()
+{
+	const std::vector< uint64_t > numbers = testNumbers();
+
+	std::vector< uint8_t > buffer( numbers.size() * max_varint_size< uint64_t >::value );
+	size_t encodedSize = 0;
+	for (uint64_t number : numbers)
+	{
+		const size_t length = encodeVarUInt( buffer.data() + encodedSize, number );
+		CHECK( length == varUIntSize( number ) );
+		encodedSize += length;
+	}
+	const uint8_t * const end = buffer.data() + encodedSize;
+
+	// one by one
+	const uint8_t * pos = buffer.data();
+	for (uint64_t number : numbers)
+	{
+		uint64_t decoded = 0;
+		const size_t length = decodeVarUInt( pos, end, decoded );
+		CHECK( length == varUIntSize( number ) );
+		CHECK( decoded == number );
+		pos += length;
+	}
+	CHECK( pos == end );
+
+	// in bulk, most of them by the branchless 8-byte decoder, the last ones near the end by the general loop
+	std::vector< uint64_t > decoded( numbers.size() );
+	CHECK( decodeVarUIntArray( buffer.data(), end, decoded.data(), decoded.size() ) == end );
+	CHECK( decoded == numbers );
+
+	// signed numbers through ZigZag
+	for (uint64_t number : numbers)
+	{
+		const int64_t value = int64_t( number );
+		CHECK( zigZagDecode( zigZagEncode( value ) ) == value );
+	}
+}
+
+static void testInvalidEncodings()
+{
+	// padded with bytes that would be valid continuations, so that the bulk decoder takes the 8-byte path
+	const auto checkRejected = []( std::vector< uint8_t > encoded )
+	{
+		const size_t size = encoded.size();
+		encoded.resize( size + 16, 0x01 );
+		uint64_t value;
+		CHECK( decodeVarUInt( encoded.data(), encoded.data() + size, value ) == 0 );
+		CHECK( decodeVarUInt( encoded.data(), encoded.data() + encoded.size(), value ) == 0 );
+		CHECK( decodeVarUIntArray( encoded.data(), encoded.data() + encoded.size(), &value, 1 ) == nullptr );
+	};
+
+	// overlong
+	checkRejected({ 0x80, 0x00 });
+	checkRejected({ 0xFF, 0x80, 0x00 });
+	checkRejected({ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 });
+	checkRejected({ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 });
+	// longer than 10 bytes
+	checkRejected({ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 });
+	// doesn't fit into 64 bits
+	checkRejected({ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02 });
+
+	// truncated
+	const uint8_t truncated [] = { 0x80, 0x80 };
+	uint64_t value;
+	CHECK( decodeVarUInt( truncated, truncated + 2, value ) == 0 );
+
+	// doesn't fit into a smaller type
+	const uint8_t large [] = { 0x80, 0x80, 0x04 };
+	uint16_t value16;
+	CHECK( decodeVarUInt( large, large + 3, value16 ) == 0 );
+}
+
+int main()
+{
+	testRoundTrip();
+	testInvalidEncodings();
+
+	if (g_numFailures != 0)
+	{
+		std::printf( "%d checks failed\n", g_numFailures );
+		return 1;
+	}
+	return 0;
+}